@@ -0,0 +1,166 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <iostream>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "async_sink.h"
+
+
+namespace logging {
+
+  async_sink_worker::async_sink_worker (std::ostream* stream,
+                                        const record_formatter& formatter,
+                                        const async_sink_options& options)
+    : m_stream(stream)
+    , m_formatter(formatter)
+    , m_options(options)
+    , m_is_active(true)
+    , m_is_idle(false)
+    , m_count(0)
+    , m_last_time(0)
+    , m_max_time(0)
+    , m_total_time(0)
+    , m_degraded(false)
+    , m_write_start(0)
+  {
+    m_thread = std::thread(async_sink_worker::worker_call, this);
+  }
+
+  async_sink_worker::~async_sink_worker () {
+    stop();
+  }
+
+  void async_sink_worker::stop () {
+    if (m_thread.joinable()) {
+      m_is_active = false;
+      m_queue.wake();
+      m_thread.join();
+    }
+  }
+
+  namespace {
+
+    std::int64_t steady_now_us () {
+      return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+  } // namespace
+
+  void async_sink_worker::enqueue (const record& entry) {
+    const auto budget = m_options.write_budget.count();
+    if ((budget > 0) && !m_degraded) {
+      const auto start = m_write_start.load();
+      if ((start > 0) && ((steady_now_us() - start) > budget)) {
+        // the running write hangs, bound the queue before it grows without limit.
+        degrade();
+      }
+    }
+    m_queue.enqueue(record(entry));
+  }
+
+  void async_sink_worker::degrade () {
+    if (!m_degraded.exchange(true)) {
+      m_queue.set_limits(m_options.degraded_limits);
+    }
+  }
+
+  bool async_sink_worker::wait_until_empty (const std::chrono::milliseconds& timeout) {
+    const auto end = std::chrono::steady_clock::now() + timeout;
+    m_queue.wait_until_empty(timeout);
+    while (!m_is_idle && (std::chrono::steady_clock::now() < end)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return m_is_idle && m_queue.empty();
+  }
+
+  sink_stats async_sink_worker::get_stats () const {
+    sink_stats stats;
+    stats.count = m_count;
+    stats.last_time = std::chrono::microseconds(m_last_time.load());
+    stats.max_time = std::chrono::microseconds(m_max_time.load());
+    stats.total_time = std::chrono::microseconds(m_total_time.load());
+    stats.degraded = m_degraded;
+    for (std::size_t i = 0; i < drop_counter::level_count; ++i) {
+      stats.dropped += m_queue.dropped().get(static_cast<level>(i));
+    }
+    return stats;
+  }
+
+  void async_sink_worker::write (const record& entry) {
+    const auto start = std::chrono::steady_clock::now();
+    m_write_start = std::max<std::int64_t>(steady_now_us(), 1);
+    try {
+      m_formatter(*m_stream, entry);
+      m_stream->flush();
+    } catch (const std::exception& ex) {
+      std::cerr << "async_sink_worker::write:" << ex.what();
+    }
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    m_write_start = 0;
+
+    ++m_count;
+    m_last_time = us;
+    m_total_time += us;
+    if (us > m_max_time) {
+      m_max_time = us;
+    }
+
+    const auto budget = m_options.write_budget.count();
+    if ((budget > 0) && (us > budget)) {
+      degrade();
+    }
+  }
+
+  void async_sink_worker::worker_call (async_sink_worker* worker) {
+    std::vector<record> batch;
+    auto is_stopped = [worker] () -> bool {
+      return !worker->m_is_active;
+    };
+
+    for (;;) {
+      worker->m_queue.drain(batch);
+      if (batch.empty()) {
+        if (!worker->m_is_active) {
+          worker->m_is_idle = true;
+          break;
+        }
+        if (worker->m_degraded && (worker->m_last_time <= worker->m_options.write_budget.count())) {
+          // catched up and in budget again.
+          worker->m_queue.set_limits(queue_limits());
+          worker->m_degraded = false;
+        }
+        worker->m_is_idle = true;
+        worker->m_queue.wait_for_items(is_stopped);
+        worker->m_is_idle = false;
+      } else {
+        for (auto& entry : batch) {
+          worker->write(entry);
+        }
+        batch.clear();
+      }
+    }
+  }
+
+} // namespace logging
@@ -0,0 +1,137 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#if defined USE_MINGW && __MINGW_GCC_VERSION < 100000
+#include <mingw/mingw.thread.h>
+#endif
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "message_queue.h"
+#include "formatter.h"
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Options of a sink with an own worker thread.
+    */
+  struct async_sink_options {
+    /// Maximal time of one write, before the sink is degraded. 0 means no budget.
+    std::chrono::microseconds write_budget{0};
+
+    /// Queue limits of the sink while it is degraded.
+    queue_limits degraded_limits = default_degraded_limits();
+
+    static queue_limits default_degraded_limits () {
+      queue_limits limits;
+      limits.max_records = 10000;
+      limits.policy = overflow_policy::drop_newest;
+      return limits;
+    }
+  };
+
+  /**
+    * Write statistics of an async sink.
+    */
+  struct sink_stats {
+    std::size_t count = 0;
+    std::size_t dropped = 0;
+    std::chrono::microseconds last_time{0};
+    std::chrono::microseconds max_time{0};
+    std::chrono::microseconds total_time{0};
+    bool degraded = false;
+  };
+
+  /**
+    * Own queue and thread for one sink.
+    * Measures the write time and degrades the sink, if it exceeds the budget.
+    * A write that does not return is detected when the next record is
+    * enqueued, so a hanging sink is degraded and its queue bounded as well.
+    * A degraded sink uses the degraded queue limits until it keeps the budget
+    * again and has catched up with its queue.
+    */
+  class LOGGING_EXPORT async_sink_worker {
+  public:
+    async_sink_worker (std::ostream* stream,
+                       const record_formatter& formatter,
+                       const async_sink_options& options);
+
+    /// Writes the remaining records and joins the thread.
+    ~async_sink_worker ();
+
+    /// Writes the remaining records and joins the thread, the stream is no longer used when it returns.
+    void stop ();
+
+    /// Enqueue a copy of the record, degrades the sink if the running write exceeds the budget.
+    void enqueue (const record& entry);
+
+    /// Waits until the queue is empty and written for maximum timeout time span, returns false on timeout.
+    bool wait_until_empty (const std::chrono::milliseconds& timeout);
+
+    /// Current write statistics.
+    sink_stats get_stats () const;
+
+    async_sink_worker (const async_sink_worker&) = delete;
+    void operator= (const async_sink_worker&) = delete;
+
+  private:
+    static void worker_call (async_sink_worker* worker);
+
+    void write (const record& entry);
+
+    /// switch to the degraded queue limits, if not yet degraded.
+    void degrade ();
+
+    std::ostream* m_stream;
+    record_formatter m_formatter;
+    async_sink_options m_options;
+
+    message_queue m_queue;
+    std::atomic_bool m_is_active;
+    std::atomic_bool m_is_idle;
+
+    std::atomic<std::size_t> m_count;
+    std::atomic<std::int64_t> m_last_time;
+    std::atomic<std::int64_t> m_max_time;
+    std::atomic<std::int64_t> m_total_time;
+    std::atomic_bool m_degraded;
+
+    /// start of the running write in microseconds of the steady clock, 0 while not writing.
+    std::atomic<std::int64_t> m_write_start;
+
+    std::thread m_thread;
+  };
+
+} // namespace logging
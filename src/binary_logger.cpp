@@ -0,0 +1,187 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "binary_logger.h"
+#include "format_registry.h"
+
+
+namespace logging {
+
+  /*
+   * Binary stream layout:
+   * header: "LOGB", version (u32)
+   * 'F' format: id (u32), size (u32), text
+   * 'T' thread name: id (u32), size (u32), text
+   * 'R' record: time in ns since epoch (i64), line (u32), level (u8), thread id (u32),
+   *     os thread id (u32), format id (u32), message size (u32), fields size (u32),
+   *     message, fields
+   */
+
+  namespace {
+
+    const char magic[4] = { 'L', 'O', 'G', 'B' };
+    const std::uint32_t version = 1;
+
+    template <typename T>
+    inline void put (std::ostream& out, const T& value) {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline bool get (std::istream& in, T& value) {
+      return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    inline void put_text (std::ostream& out, char type, std::uint32_t id, std::string_view text) {
+      out.put(type);
+      put(out, id);
+      put(out, static_cast<std::uint32_t>(text.size()));
+      out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    inline bool get_text (std::istream& in, std::string& text) {
+      std::uint32_t size = 0;
+      if (!get(in, size)) {
+        return false;
+      }
+      text.resize(size);
+      return (size == 0) || static_cast<bool>(in.read(&text[0], size));
+    }
+
+    /// marks ids already written to the stream.
+    inline bool is_new (std::vector<bool>& written, std::uint32_t id) {
+      if (id >= written.size()) {
+        written.resize(id + 1);
+      }
+      const bool result = !written[id];
+      written[id] = true;
+      return result;
+    }
+
+    struct dictionary {
+      bool m_header = false;
+      std::vector<bool> m_formats;
+      std::vector<bool> m_threads;
+    };
+
+  } // namespace
+
+  record_formatter binary_formatter () {
+    auto dict = std::make_shared<dictionary>();
+    return [dict] (std::ostream& out, const record& e) {
+      if (!dict->m_header) {
+        out.write(magic, sizeof(magic));
+        put(out, version);
+        dict->m_header = true;
+      }
+      if (e.format_id() && is_new(dict->m_formats, e.format_id())) {
+        put_text(out, 'F', e.format_id(), format_registry::format(e.format_id()));
+      }
+      if (is_new(dict->m_threads, e.thread_id())) {
+        put_text(out, 'T', e.thread_id(), e.thread_name());
+      }
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(e.time_point().time_since_epoch());
+      out.put('R');
+      put(out, static_cast<std::int64_t>(ns.count()));
+      put(out, static_cast<std::uint32_t>(e.line().n));
+      put(out, static_cast<std::uint8_t>(e.level()));
+      put(out, e.thread_id());
+      put(out, e.os_thread_id());
+      put(out, e.format_id());
+      put(out, static_cast<std::uint32_t>(e.message().size()));
+      put(out, static_cast<std::uint32_t>(e.fields().size()));
+      out.write(e.message().data(), static_cast<std::streamsize>(e.message().size()));
+      out.write(e.fields().data(), static_cast<std::streamsize>(e.fields().size()));
+    };
+  }
+
+  binary_reader::binary_reader (std::istream& in)
+    : m_in(in)
+    , m_valid(false)
+  {
+    char header[sizeof(magic)];
+    std::uint32_t v = 0;
+    if (m_in.read(header, sizeof(header)) && get(m_in, v)) {
+      m_valid = (std::memcmp(header, magic, sizeof(magic)) == 0) && (v == version);
+    }
+  }
+
+  bool binary_reader::is_valid () const {
+    return m_valid;
+  }
+
+  bool binary_reader::read (record& entry) {
+    if (!m_valid) {
+      return false;
+    }
+    char type = 0;
+    std::uint32_t id = 0;
+    while (m_in.get(type)) {
+      switch (type) {
+        case 'F':
+          if (!get(m_in, id) || !get_text(m_in, m_message)) {
+            return false;
+          }
+          m_formats[id] = format_registry::register_format(m_message);
+          break;
+        case 'T':
+          if (!get(m_in, id) || !get_text(m_in, m_message)) {
+            return false;
+          }
+          m_threads[id] = thread_registry::register_name(m_message);
+          break;
+        case 'R': {
+          std::int64_t ns = 0;
+          std::uint32_t line = 0, thread_id = 0, os_thread_id = 0, format_id = 0, message_size = 0, fields_size = 0;
+          std::uint8_t lvl = 0;
+          if (!get(m_in, ns) || !get(m_in, line) || !get(m_in, lvl) || !get(m_in, thread_id) ||
+              !get(m_in, os_thread_id) || !get(m_in, format_id) || !get(m_in, message_size) || !get(m_in, fields_size)) {
+            return false;
+          }
+          m_message.resize(message_size);
+          m_fields.resize(fields_size);
+          if ((message_size && !m_in.read(&m_message[0], message_size)) ||
+              (fields_size && !m_in.read(&m_fields[0], fields_size))) {
+            return false;
+          }
+          const std::chrono::system_clock::time_point tp(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+          entry = record(tp, static_cast<level>(lvl), m_threads[thread_id], os_thread_id, line_id(line),
+                         m_message, m_fields, format_id ? m_formats[format_id] : 0);
+          return true;
+        }
+        default:
+          m_valid = false;
+          return false;
+      }
+    }
+    return false;
+  }
+
+} // namespace logging
@@ -0,0 +1,101 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <unordered_map>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Formatter that writes records in a compact binary form.
+    *
+    * The stream starts with a header, each format and thread name is written
+    * once as dictionary entry before the first record that uses it. Records
+    * are written as frames with the raw message or the encoded arguments of
+    * a deferred format. Numbers are stored in host byte order.
+    * Each call returns a formatter with an own dictionary, use it for one stream.
+    */
+  LOGGING_EXPORT record_formatter binary_formatter ();
+
+  /**
+    * Reads the records of a stream written by the binary formatter.
+    * Formats and thread names are registered in the registries of this process,
+    * so the records can be written with the text formatters.
+    */
+  class LOGGING_EXPORT binary_reader {
+  public:
+    explicit binary_reader (std::istream& in);
+
+    /// true if the stream starts with a valid header.
+    bool is_valid () const;
+
+    /// read the next record, returns false at the end or at invalid data.
+    bool read (record& entry);
+
+  private:
+    std::istream& m_in;
+    bool m_valid;
+    std::string m_message;
+    std::string m_fields;
+    std::unordered_map<std::uint32_t, std::uint32_t> m_formats;
+    std::unordered_map<std::uint32_t, std::uint32_t> m_threads;
+  };
+
+  /**
+    * log to a binary file, decode it with logging-decode.
+    * Automatic adds and remove itself to the logging core.
+    */
+  class binary_file_logger {
+  public:
+    binary_file_logger (const std::string& name, level lvl,
+                        const flush_policy& flush = flush_policy())
+      : file(name, std::ios_base::out|std::ios_base::trunc|std::ios_base::binary)
+    {
+      core::instance().add_sink(&file, lvl, binary_formatter(), flush);
+    }
+
+    ~binary_file_logger () {
+      core::instance().remove_sink(&file);
+      file.close();
+    }
+
+  private:
+    std::ofstream file;
+  };
+
+} // namespace logging
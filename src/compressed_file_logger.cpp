@@ -0,0 +1,148 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <zlib.h>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "compressed_file_logger.h"
+
+
+namespace logging {
+
+  /**
+    * zlib deflate stream, reset for each block.
+    */
+  class deflater {
+  public:
+    explicit deflater (int level)
+      : m_valid(false)
+    {
+      m_stream.zalloc = Z_NULL;
+      m_stream.zfree = Z_NULL;
+      m_stream.opaque = Z_NULL;
+      // 16 + window bits writes a gzip header and trailer.
+      m_valid = (deflateInit2(&m_stream, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    }
+
+    ~deflater () {
+      if (m_valid) {
+        deflateEnd(&m_stream);
+      }
+    }
+
+    /// compress data as one complete gzip member into out.
+    bool compress (const char* data, std::size_t size, std::string& out) {
+      if (!m_valid || (deflateReset(&m_stream) != Z_OK)) {
+        return false;
+      }
+      out.resize(deflateBound(&m_stream, static_cast<uLong>(size)));
+      m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+      m_stream.avail_in = static_cast<uInt>(size);
+      m_stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+      m_stream.avail_out = static_cast<uInt>(out.size());
+      if (deflate(&m_stream, Z_FINISH) != Z_STREAM_END) {
+        return false;
+      }
+      out.resize(m_stream.total_out);
+      return true;
+    }
+
+  private:
+    z_stream m_stream;
+    bool m_valid;
+  };
+
+  compressed_file_buffer::compressed_file_buffer ()
+  {}
+
+  compressed_file_buffer::~compressed_file_buffer () {
+    close();
+  }
+
+  bool compressed_file_buffer::open (const std::string& name, const compressed_file_options& options) {
+    close();
+    if (!m_file.open(name, std::ios_base::out | std::ios_base::app | std::ios_base::binary)) {
+      return false;
+    }
+    m_deflater.reset(new deflater(options.level));
+    m_block.resize(std::max<std::size_t>(options.block_size, 256));
+    setp(&m_block[0], &m_block[0] + m_block.size());
+    return true;
+  }
+
+  void compressed_file_buffer::close () {
+    if (m_file.is_open()) {
+      write_block();
+      m_file.close();
+    }
+    setp(nullptr, nullptr);
+    m_deflater.reset();
+  }
+
+  bool compressed_file_buffer::is_open () const {
+    return m_file.is_open();
+  }
+
+  bool compressed_file_buffer::sync_to_storage () {
+    return m_file.is_open() && write_block() && m_file.sync_to_storage();
+  }
+
+  compressed_file_buffer::int_type compressed_file_buffer::overflow (int_type c) {
+    if (!m_file.is_open() || !write_block()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  bool compressed_file_buffer::flush_pending () {
+    return m_file.is_open() && write_block() && (m_file.pubsync() == 0);
+  }
+
+  int compressed_file_buffer::sync () {
+    // the partial block stays pending, only completed members are flushed.
+    if (!m_file.is_open()) {
+      return -1;
+    }
+    return m_file.pubsync();
+  }
+
+  bool compressed_file_buffer::write_block () {
+    const std::size_t size = static_cast<std::size_t>(pptr() - pbase());
+    if (size == 0) {
+      return true;
+    }
+    const bool compressed = m_deflater->compress(pbase(), size, m_compressed);
+    setp(&m_block[0], &m_block[0] + m_block.size());
+    if (!compressed) {
+      return false;
+    }
+    const auto n = static_cast<std::streamsize>(m_compressed.size());
+    return m_file.sputn(m_compressed.data(), n) == n;
+  }
+
+} // namespace logging
@@ -0,0 +1,132 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Options of a compressed log file.
+    */
+  struct compressed_file_options {
+    /// Uncompressed size of a block, a full block is compressed and written.
+    std::size_t block_size = 64 * 1024;
+
+    /// zlib compression level 0 to 9, -1 for the zlib default.
+    int level = -1;
+  };
+
+  class deflater;
+
+  /**
+    * Stream buffer that writes to a gzip compressed file.
+    *
+    * The data is compressed in blocks, each block is written as independent
+    * gzip member when it is full, on a forced flush of the core, on a sync,
+    * max_delay of the flush policy after its first record and on close.
+    * Normal flushes keep the partial block, so short batches do not end up
+    * as tiny members. The file can be read with gunzip or zcat, a crash loses
+    * at most the pending block.
+    * The file is opened to append, so it can be rotated by renaming.
+    */
+  class LOGGING_EXPORT compressed_file_buffer : public std::streambuf, public durable_buffer {
+  public:
+    compressed_file_buffer ();
+
+    /// writes the pending block and closes the file.
+    ~compressed_file_buffer ();
+
+    /// open the file to append, returns false on error.
+    bool open (const std::string& name, const compressed_file_options& options = compressed_file_options());
+
+    /// write the pending block and close the file.
+    void close ();
+
+    bool is_open () const;
+
+    bool sync_to_storage () override;
+
+    /// write the pending block as gzip member.
+    bool flush_pending () override;
+
+    compressed_file_buffer (const compressed_file_buffer&) = delete;
+    void operator= (const compressed_file_buffer&) = delete;
+
+  protected:
+    int_type overflow (int_type c) override;
+    int sync () override;
+
+  private:
+    /// compress the pending data as one block and write it to the file.
+    bool write_block ();
+
+    durable_filebuf m_file;
+    std::string m_block;
+    std::string m_compressed;
+    std::unique_ptr<deflater> m_deflater;
+  };
+
+  /**
+    * log to a gzip compressed file.
+    * Automatic adds and remove itself to the logging core.
+    * By default a partial block is written one second after its first record.
+    */
+  class compressed_file_logger {
+  public:
+    compressed_file_logger (const std::string& name, level lvl, const record_formatter& fmt,
+                            const compressed_file_options& options = compressed_file_options(),
+                            const flush_policy& flush = flush_policy::batched(0, std::chrono::seconds(1)))
+      : stream(&buffer)
+    {
+      if (buffer.open(name, options)) {
+        core::instance().add_sink(&stream, lvl, fmt, flush);
+      }
+    }
+
+    ~compressed_file_logger () {
+      core::instance().remove_sink(&stream);
+      buffer.close();
+    }
+
+  private:
+    compressed_file_buffer buffer;
+    std::ostream stream;
+  };
+
+} // namespace logging
@@ -20,8 +20,10 @@
 //
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 #include <chrono>
+#include <ctime>
 #include <thread>
 
 
@@ -93,6 +95,7 @@ namespace sys_fs = boost::filesystem;
 
 #include "core.h"
 #include "recorder.h"
+#include "crash_handler.h"
 
 
 #if !defined(LOGGING_BUILT_AS_STATIC_LIB)
@@ -109,27 +112,278 @@ namespace logging {
 
 namespace logging {
 
-#if (defined WIN32 || defined _WIN32 || defined WINCE || defined __CYGWIN__) && !defined(thread_local) && !defined(USE_MINGW)
-# define thread_local __declspec(thread)
-#endif
+#ifndef LOGGING_NO_THREAD
+  namespace {
+
+    /// Maximum number of records taken from one staging buffer in one pass of the sink thread.
+    constexpr std::size_t max_batch_count = 1024;
+
+    /**
+      * Staging buffer of the current thread.
+      * Closes the buffer at thread exit, the sink thread drains and releases it.
+      */
+    struct staging_slot {
+      ~staging_slot () {
+        if (m_buffer) {
+          m_buffer->close();
+        }
+      }
+
+      const core* m_owner = nullptr;
+      std::shared_ptr<staging_buffer> m_buffer;
+    };
+
+    thread_local staging_slot t_staging;
+
+    /// compare line ids, aware of the wrap around of the counter.
+    inline bool line_less (const record& lhs, const record& rhs) {
+      return static_cast<int>(lhs.line().n - rhs.line().n) < 0;
+    }
 
-  thread_local const char* t_thread_name = "main";
+  } // namespace
+#endif //LOGGING_NO_THREAD
+
+  namespace {
+
+    typedef void(formatter_function)(std::ostream&, const record&);
+
+    /// identity of a formatter given as plain function, e.g. standard_formatter, else null.
+    const void* formatter_id (const record_formatter& formatter) {
+      auto f = formatter.target<formatter_function*>();
+      return f ? reinterpret_cast<const void*>(*f) : nullptr;
+    }
+
+  } // namespace
 
 #ifndef LOGGING_NO_THREAD
   void core::logging_sink_call (core* core) {
+    staging_list buffers;
+    unsigned int version = core->update_staging(buffers);
+    core->m_sink_buffers = &buffers;
+    std::vector<record> batch;
+    drop_counter::counts reported = core->dropped_counts();
+
+    std::vector<record> priority;
+
+    auto is_pending = [&] () -> bool {
+      if (!core->m_is_active || (version != core->m_staging_version.load()) || !core->m_priority.empty()) {
+        return true;
+      }
+      for (auto& b : buffers) {
+        if (!b->empty()) {
+          return true;
+        }
+      }
+      return false;
+    };
+
     while (core->m_is_active) {
-      record entry = core->m_messages.dequeue();
-      do {
-        core->log_to_sinks(std::move(entry));
-      } while (core->m_messages.try_dequeue(entry));
+      if (core->m_emergency) {
+        core->park_for_emergency();
+        break;
+      }
+      if (version != core->m_staging_version.load()) {
+        version = core->update_staging(buffers);
+      }
+      const bool had_priority = core->log_priority(priority);
+      core->collect(batch, buffers);
+      if (batch.empty()) {
+        if (had_priority) {
+          continue;
+        }
+        // no more pressure, tell what was lost and write out what is buffered.
+        core->report_dropped(reported);
+        // wake up again, when a periodic sync is due.
+        const auto next_sync = core->flush_all_sinks(flush_trigger::idle);
+        core->m_sink_idle = true;
+        core->m_messages.wait_for_items(is_pending, next_sync);
+        core->m_sink_idle = false;
+      } else {
+        core->log_to_sinks(batch);
+        batch.clear();
+      }
+    }
+    core->m_sink_buffers = nullptr;
+  }
+
+  void core::park_for_emergency () {
+    // nothing is moved or released any more, emergency_drain can read the records.
+    m_sink_parked = true;
+    while (m_is_active) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  bool core::enqueue_staged (record& entry) {
+    if (!t_staging.m_buffer) {
+      t_staging.m_buffer = std::make_shared<staging_buffer>();
+      t_staging.m_owner = this;
+      std::lock_guard<std::mutex> lock(m_staging_mutex);
+      m_staging.push_back(t_staging.m_buffer);
+      ++m_staging_version;
+    } else if (t_staging.m_owner != this) {
+      return false;
+    }
+    if (!t_staging.m_buffer->try_enqueue(entry)) {
+      return false;
+    }
+    m_messages.wake();
+    return true;
+  }
+
+  unsigned int core::update_staging (staging_list& buffers) {
+    std::lock_guard<std::mutex> lock(m_staging_mutex);
+    auto end = std::remove_if(m_staging.begin(), m_staging.end(), [] (const std::shared_ptr<staging_buffer>& b) {
+      return b->is_closed() && b->empty();
+    });
+    if (end != m_staging.end()) {
+      m_staging.erase(end, m_staging.end());
+      ++m_staging_version;
+    }
+    buffers = m_staging;
+    return m_staging_version.load();
+  }
+
+  void core::collect (std::vector<record>& batch, const staging_list& buffers) {
+    m_messages.drain(batch);
+
+    record entry;
+    bool staged = false;
+    for (auto& b : buffers) {
+      if (b->is_closed() && b->empty()) {
+        // let the next update_staging release it.
+        ++m_staging_version;
+        continue;
+      }
+      for (std::size_t i = 0; (i < max_batch_count) && b->try_dequeue(entry); ++i) {
+        batch.emplace_back(std::move(entry));
+        staged = true;
+      }
+    }
+    if (staged) {
+      // line ids are unique, so no stable sort with its unaligned temporary buffer is needed.
+      std::sort(batch.begin(), batch.end(), line_less);
+    }
+  }
+
+  drop_counter::counts core::dropped_counts () const {
+    drop_counter::counts counts = m_messages.dropped().get_all();
+    const drop_counter::counts priority = m_priority.dropped().get_all();
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += priority[i];
+    }
+    return counts;
+  }
+
+  void core::report_dropped (drop_counter::counts& reported) {
+    const drop_counter::counts current = dropped_counts();
+    std::size_t total = 0;
+    std::ostringstream details;
+    for (std::size_t i = 0; i < current.size(); ++i) {
+      const std::size_t count = current[i] - reported[i];
+      if (count > 0) {
+        details << (total ? ", " : "") << static_cast<level>(i) << ": " << count;
+        total += count;
+      }
+    }
+    if (total > 0) {
+      reported = current;
+      std::ostringstream buf;
+      buf << total << " records dropped due to the queue limits (" << details.str() << ")";
+      log_to_sinks(record(std::chrono::system_clock::now(), level::warning,
+                          line_id(++m_line_id), buf.str()));
+    }
+  }
+
+  bool core::log_priority (std::vector<record>& batch) {
+    if (m_priority.drain(batch) == 0) {
+      return false;
+    }
+    // log_to_sinks flushes by the policy of each sink, errors alone do not force syncs.
+    log_to_sinks(batch);
+    if (m_persist_count.load() > 0) {
+      std::vector<std::promise<void>> promises;
+      level persisted_level = level::undefined;
+      {
+        std::lock_guard<std::mutex> lock(m_persist_mutex);
+        for (auto& entry : batch) {
+          auto i = m_persist_promises.find(entry.line().n);
+          if (i != m_persist_promises.end()) {
+            promises.emplace_back(std::move(i->second));
+            persisted_level = std::max(persisted_level, entry.level());
+            m_persist_promises.erase(i);
+            --m_persist_count;
+          }
+        }
+      }
+      if (!promises.empty()) {
+        // a persisted record must be on the storage, before its promise is fulfilled.
+        flush_all_sinks(flush_trigger::forced);
+        const bool written = wait_for_async_sinks(persisted_level, std::chrono::milliseconds(
+#ifdef NDEBUG
+          500
+#else
+          2000
+#endif
+        ));
+        for (auto& promise : promises) {
+          if (written) {
+            promise.set_value();
+          } else {
+            promise.set_exception(std::make_exception_ptr(std::runtime_error("an async sink did not write the persisted record in time")));
+          }
+        }
+      }
+    }
+    batch.clear();
+    return true;
+  }
+
+  void core::wait_until_empty (const std::chrono::milliseconds& timeout) {
+    const auto end = std::chrono::steady_clock::now() + timeout;
+    m_priority.wait_until_empty(timeout);
+    m_messages.wait_until_empty(std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()));
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(m_staging_mutex);
+        // check the sink thread last, the records could be on the way to the sinks.
+        if (std::all_of(m_staging.begin(), m_staging.end(), [] (const std::shared_ptr<staging_buffer>& b) {
+                          return b->empty();
+                        }) && m_sink_idle) {
+          break;
+        }
+      }
+      if (std::chrono::steady_clock::now() >= end) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    wait_for_async_sinks(std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()));
+  }
+
+  void core::wait_for_async_sinks (const std::chrono::milliseconds& timeout) {
+    wait_for_async_sinks(level::fatal, timeout);
+  }
+
+  bool core::wait_for_async_sinks (level lvl, const std::chrono::milliseconds& timeout) {
+    const auto end = std::chrono::steady_clock::now() + timeout;
+    const auto sinks = get_sinks();
+    bool written = true;
+    for (auto& s : *sinks) {
+      if (s.m_worker && (s.m_level <= lvl) && (m_level <= lvl)) {
+        written &= s.m_worker->wait_until_empty(std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now()));
+      }
     }
+    return written;
   }
 #endif //LOGGING_NO_THREAD
 
   core::core ()
     : m_level(level::info)
+    , m_min_level(level::info)
     , m_is_active(false)
     , m_line_id(0)
+    , m_sinks(std::make_shared<sink_list>())
   {
     start();
   }
@@ -139,13 +393,47 @@ namespace logging {
   }
 
   void core::set_log_level (level lvl) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_level = lvl;
+    update_min_level(*get_sinks());
+  }
+
+  void core::update_min_level (const sink_list& sinks) {
+    // above fatal, no record is enabled without a sink.
+    const level none = static_cast<level>(static_cast<int>(level::fatal) + 1);
+    level lvl = none;
+    level recorder_lvl = none;
+    for (auto& s : sinks) {
+      if (s.m_recorder) {
+        recorder_lvl = std::min(recorder_lvl, s.m_level);
+      } else {
+        lvl = std::min(lvl, s.m_level);
+      }
+    }
+    // flight recorders are not limited by the global level.
+    m_min_level = std::min(std::max(m_level.load(), lvl), recorder_lvl);
   }
 
   level core::get_log_level () const {
     return m_level;
   }
 
+  void core::set_staging (bool enable) {
+#ifndef LOGGING_NO_THREAD
+    m_use_staging = enable;
+#else
+    (void)enable;
+#endif //LOGGING_NO_THREAD
+  }
+
+  bool core::get_staging () const {
+#ifndef LOGGING_NO_THREAD
+    return m_use_staging;
+#else
+    return false;
+#endif //LOGGING_NO_THREAD
+  }
+
   void core::start () {
 #ifndef LOGGING_NO_THREAD
     if (!m_is_active) {
@@ -167,7 +455,7 @@ namespace logging {
   void core::finish () {
 #ifndef LOGGING_NO_THREAD
     if (m_is_active) {
-      m_messages.wait_until_empty(std::chrono::milliseconds(
+      wait_until_empty(std::chrono::milliseconds(
 #ifdef NDEBUG
         500
 #else
@@ -175,8 +463,33 @@ namespace logging {
 #endif
       ));
       m_is_active = false;
-      m_messages.enqueue(record());
+      // wake the sink thread without a record, that could block on a full queue or count as dropped.
+      m_messages.wake();
       m_sink_thread.join();
+
+      // write what is left in the queues and in the staging buffers.
+      staging_list buffers;
+      update_staging(buffers);
+      std::vector<record> batch;
+      do {
+        batch.clear();
+        log_priority(batch);
+        collect(batch, buffers);
+        log_to_sinks(batch);
+      } while (!batch.empty());
+      flush_all_sinks();
+      wait_for_async_sinks(std::chrono::milliseconds(
+#ifdef NDEBUG
+        500
+#else
+        2000
+#endif
+      ));
+
+      // the rest will never be written.
+      std::lock_guard<std::mutex> lock(m_persist_mutex);
+      m_persist_promises.clear();
+      m_persist_count = 0;
     }
 #endif //LOGGING_NO_THREAD
   }
@@ -184,7 +497,7 @@ namespace logging {
   void core::flush () {
 #ifndef LOGGING_NO_THREAD
     if (m_is_active) {
-      m_messages.wait_until_empty(std::chrono::milliseconds(
+      wait_until_empty(std::chrono::milliseconds(
 #ifdef NDEBUG
         500
 #else
@@ -192,6 +505,38 @@ namespace logging {
 #endif
       ));
     }
+#endif //LOGGING_NO_THREAD
+    flush_all_sinks();
+  }
+
+  void core::set_queue_limits (const queue_limits& limits) {
+#ifndef LOGGING_NO_THREAD
+    m_messages.set_limits(limits);
+    // the priority lane keeps the errors it already accepted.
+    queue_limits priority_limits = limits;
+    if (priority_limits.policy == overflow_policy::drop_oldest) {
+      priority_limits.policy = overflow_policy::drop_newest;
+    }
+    m_priority.set_limits(priority_limits);
+#else
+    (void)limits;
+#endif //LOGGING_NO_THREAD
+  }
+
+  queue_limits core::get_queue_limits () const {
+#ifndef LOGGING_NO_THREAD
+    return m_messages.get_limits();
+#else
+    return queue_limits();
+#endif //LOGGING_NO_THREAD
+  }
+
+  std::size_t core::get_dropped_count (level lvl) const {
+#ifndef LOGGING_NO_THREAD
+    return m_messages.dropped().get(lvl) + m_priority.dropped().get(lvl);
+#else
+    (void)lvl;
+    return 0;
 #endif //LOGGING_NO_THREAD
   }
 
@@ -208,21 +553,40 @@ namespace logging {
   }
 
   void core::log (level lvl,
-                  std::string&& message) {
-    log(lvl, std::chrono::system_clock::now(), std::move(message));
+                  std::string_view message) {
+    log(lvl, std::chrono::system_clock::now(), message);
   }
 
   void core::log (level lvl,
                   std::chrono::system_clock::time_point time_point,
-                  std::string&& message) {
+                  std::string_view message,
+                  std::string_view fields) {
+    if (!is_enabled(lvl)) {
+      return;
+    }
+    unsigned int id = ++m_line_id;
+    dispatch(record(time_point, lvl, line_id(id), message, fields));
+  }
+
+  void core::log_deferred (level lvl,
+                           std::uint32_t format_id,
+                           std::string_view args) {
+    if (!is_enabled(lvl)) {
+      return;
+    }
     unsigned int id = ++m_line_id;
-    record r(time_point, lvl, t_thread_name, line_id(id), std::move(message));
+    dispatch(record(std::chrono::system_clock::now(), lvl, line_id(id), std::string_view(), args, format_id));
+  }
+
+  void core::dispatch (record&& r) {
 #ifndef LOGGING_NO_THREAD
     if (m_is_active) {
-      m_messages.enqueue(std::move(r));
-      if (lvl >= level::error) {
-        // wait up to 3 seconds until all messages are written!
-        m_messages.wait_until_empty(std::chrono::milliseconds(1000));
+      if (r.level() >= level::error) {
+        // errors pass the backlog in the priority lane, that has its own limits.
+        m_priority.enqueue(std::move(r));
+        m_messages.wake();
+      } else if (!m_use_staging.load(std::memory_order_relaxed) || !enqueue_staged(r)) {
+        m_messages.enqueue(std::move(r));
       }
     } else {
 #endif //LOGGING_NO_THREAD
@@ -232,45 +596,435 @@ namespace logging {
 #endif //LOGGING_NO_THREAD
   }
 
+  std::future<void> core::log_persisted (level lvl,
+                                         std::chrono::system_clock::time_point time_point,
+                                         std::string_view message,
+                                         std::string_view fields) {
+    std::promise<void> promise;
+    std::future<void> future = promise.get_future();
+    if (!is_enabled(lvl)) {
+      promise.set_value();
+      return future;
+    }
+    unsigned int id = ++m_line_id;
+    record r(time_point, lvl, line_id(id), message, fields);
+#ifndef LOGGING_NO_THREAD
+    if (m_is_active) {
+      {
+        std::lock_guard<std::mutex> lock(m_persist_mutex);
+        m_persist_promises.emplace(id, std::move(promise));
+        ++m_persist_count;
+      }
+      // a dropped record would never fulfil its promise.
+      m_priority.enqueue_waiting(std::move(r));
+      m_messages.wake();
+      return future;
+    }
+#endif //LOGGING_NO_THREAD
+    log_to_sinks(std::move(r));
+    promise.set_value();
+    return future;
+  }
+
   void core::log_to_sinks (record&& entry) {
-    if (entry.level() >= m_level) {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      for (auto& s : m_sinks) {
-        if (entry.level() >= s.m_level) {
-          try {
-            s.m_formatter(*s.m_stream, entry);
+    if (entry.level() >= m_min_level) {
+      std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+      const auto sinks = get_sinks();
+      set_in_flight(&entry, 1);
+      write_to_sinks(*sinks, entry, m_level);
+      set_in_flight(nullptr, 0);
+      flush_sinks(*sinks, flush_trigger::batch);
+    }
+  }
+
+  void core::log_to_sinks (const std::vector<record>& batch) {
+    std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+    const auto sinks = get_sinks();
+    const level lvl = m_level;
+    set_in_flight(batch.data(), batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      m_in_flight_index.store(i, std::memory_order_relaxed);
+#ifndef LOGGING_NO_THREAD
+      if (m_emergency.load(std::memory_order_relaxed)) {
+        park_for_emergency();
+        break;
+      }
+#endif //LOGGING_NO_THREAD
+      write_to_sinks(*sinks, batch[i], lvl);
+    }
+    set_in_flight(nullptr, 0);
+    flush_sinks(*sinks, flush_trigger::batch);
+  }
+
+  void core::set_in_flight (const record* records, std::size_t count) {
+    if (records) {
+      m_in_flight_size.store(count, std::memory_order_relaxed);
+      m_in_flight_index.store(0, std::memory_order_relaxed);
+      m_in_flight_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+    m_in_flight.store(records, std::memory_order_release);
+  }
+
+  void core::write_to_sinks (const sink_list& sinks, const record& entry, level global_lvl) {
+    // render once per distinct formatter.
+    m_rendered.assign(m_rendered.size(), false);
+    for (auto& s : sinks) {
+      if (entry.level() >= s.m_level) {
+        if (s.m_recorder) {
+          s.m_recorder->add(entry);
+          if (entry.level() >= level::fatal) {
+            s.m_recorder->dump();
+          }
+          continue;
+        }
+        if (entry.level() < global_lvl) {
+          continue;
+        }
+        if (s.m_worker) {
+          s.m_worker->enqueue(entry);
+          continue;
+        }
+        try {
+          const std::size_t slot = s.m_render_slot;
+          if (slot >= m_renders.size()) {
+            while (m_renders.size() <= slot) {
+              m_renders.emplace_back(new render_stream());
+            }
+            m_rendered.resize(m_renders.size(), false);
+          }
+          render_stream& out = *m_renders[slot];
+          if (!m_rendered[slot]) {
+            out.clear();
+            s.m_formatter(out, entry);
+            m_rendered[slot] = true;
+          }
+          s.m_stream->write(out.data(), static_cast<std::streamsize>(out.size()));
+          auto& pending = *s.m_pending;
+          if ((pending.m_bytes == 0) && (s.m_flush.max_delay.count() > 0)) {
+            pending.m_since = std::chrono::steady_clock::now();
+            if (!pending.m_kept) {
+              pending.m_kept = true;
+              pending.m_kept_since = pending.m_since;
+            }
+          }
+          pending.m_bytes += out.size();
+          const durability mode = s.m_flush.mode;
+          if ((mode > durability::flush) && !pending.m_unsynced) {
+            pending.m_unsynced = true;
+            pending.m_unsynced_since = std::chrono::steady_clock::now();
+          }
+          if ((mode == durability::sync_on_level) && (entry.level() >= s.m_flush.sync_level)) {
+            sync_sink(s);
+          } else if ((mode != durability::none) &&
+                     ((entry.level() >= s.m_flush.flush_level) ||
+                      ((s.m_flush.max_bytes > 0) && (pending.m_bytes >= s.m_flush.max_bytes)))) {
             s.m_stream->flush();
-          } catch (const std::exception& ex) {
-            std::cerr << "core::log_to_sinks:" << ex.what();
+            pending.m_bytes = 0;
+          }
+        } catch (const std::exception& ex) {
+          std::cerr << "core::log_to_sinks:" << ex.what();
+        }
+      }
+    }
+  }
+
+  std::chrono::steady_clock::time_point core::flush_sinks (const sink_list& sinks, flush_trigger trigger) {
+    auto next_sync = std::chrono::steady_clock::time_point::max();
+    std::chrono::steady_clock::time_point now;
+    auto get_now = [&now] () {
+      if (now.time_since_epoch().count() == 0) {
+        now = std::chrono::steady_clock::now();
+      }
+      return now;
+    };
+    for (auto& s : sinks) {
+      auto& pending = *s.m_pending;
+      if (s.m_stream && !s.m_worker) {
+        bool write_kept = (trigger == flush_trigger::forced);
+        if (pending.m_kept && !write_kept && (s.m_flush.mode != durability::none)) {
+          // a quiet sink must not keep its output back for ever.
+          const auto kept_due = pending.m_kept_since + s.m_flush.max_delay;
+          write_kept = (get_now() >= kept_due);
+          if (!write_kept) {
+            next_sync = std::min(next_sync, kept_due);
+          }
+        }
+        if (write_kept) {
+          pending.m_kept = false;
+          if (auto* buffer = dynamic_cast<durable_buffer*>(s.m_stream->rdbuf())) {
+            buffer->flush_pending();
           }
         }
       }
+      const durability mode = s.m_flush.mode;
+      if (pending.m_unsynced) {
+        const auto sync_due = pending.m_unsynced_since + s.m_flush.sync_interval;
+        if ((trigger == flush_trigger::forced) || (mode == durability::group_commit) ||
+            ((mode == durability::periodic_sync) && (get_now() >= sync_due))) {
+          sync_sink(s);
+          continue;
+        }
+        if (mode == durability::periodic_sync) {
+          next_sync = std::min(next_sync, sync_due);
+        }
+      }
+      if (pending.m_bytes == 0) {
+        continue;
+      }
+      // durability::none keeps the output in the stream buffer until the sink is flushed by force.
+      bool due = (trigger == flush_trigger::forced) ||
+                 ((mode != durability::none) &&
+                  ((trigger == flush_trigger::idle) || ((s.m_flush.max_bytes == 0) && (s.m_flush.max_delay.count() == 0))));
+      if (!due && (mode != durability::none) && (s.m_flush.max_delay.count() > 0)) {
+        due = (get_now() - pending.m_since) >= s.m_flush.max_delay;
+      }
+      if (due) {
+        try {
+          s.m_stream->flush();
+        } catch (const std::exception& ex) {
+          std::cerr << "core::flush_sinks:" << ex.what();
+        }
+        pending.m_bytes = 0;
+      }
     }
+    return next_sync;
+  }
+
+  void core::sync_sink (const sink& s) {
+    auto& pending = *s.m_pending;
+    try {
+      s.m_stream->flush();
+      if (auto* buffer = dynamic_cast<durable_buffer*>(s.m_stream->rdbuf())) {
+        buffer->sync_to_storage();
+      }
+    } catch (const std::exception& ex) {
+      std::cerr << "core::sync_sink:" << ex.what();
+    }
+    pending.m_bytes = 0;
+    pending.m_unsynced = false;
+    pending.m_kept = false;
+  }
+
+  void core::sync () {
+    // the forced flush syncs all sinks with unsynced output.
+    flush();
+  }
+
+  void core::emergency_drain (int fd) {
+#ifndef WIN32
+    ++m_crash_readers;
+    emergency_writer writer;
+    const level global_lvl = m_level;
+    writer.add(fd, global_lvl);
+    for (auto& target : m_crash_targets) {
+      durable_buffer* buffer = target.m_buffer;
+      if (!buffer) {
+        break;
+      }
+      writer.add(buffer->emergency_fd(), std::max(global_lvl, target.m_level.load()));
+    }
+    m_emergency = true;
+    const std::thread::id self = std::this_thread::get_id();
+    // the records of the sink thread can only be read, while it does not move or release them.
+    bool sink_stopped = true;
+#ifndef LOGGING_NO_THREAD
+    if (m_is_active && (m_sink_thread.get_id() != self)) {
+      const struct timespec step = { 0, 1000000 };
+      for (int waited = 0; !m_sink_parked && !m_sink_idle; ++waited) {
+        if (waited >= LOGGING_EMERGENCY_WAIT_MS) {
+          sink_stopped = false;
+          break;
+        }
+        nanosleep(&step, nullptr);
+      }
+    }
+#endif //LOGGING_NO_THREAD
+    // the records the dispatch is writing right now are the oldest, the current one may be written twice.
+    const record* in_flight = m_in_flight.load(std::memory_order_acquire);
+    const std::thread::id owner = m_in_flight_thread.load(std::memory_order_relaxed);
+    if (in_flight && ((owner == self) || (sink_stopped && (owner != std::thread::id())
+#ifndef LOGGING_NO_THREAD
+                                          && (owner == m_sink_thread.get_id())
+#endif //LOGGING_NO_THREAD
+                                          ))) {
+      const std::size_t size = m_in_flight_size.load(std::memory_order_relaxed);
+      for (std::size_t i = m_in_flight_index.load(std::memory_order_relaxed); i < size; ++i) {
+        writer.write(in_flight[i]);
+      }
+    }
+#ifndef LOGGING_NO_THREAD
+    auto write = [&writer] (const record& entry) {
+      writer.write(entry);
+    };
+    // the locked queues are guarded against changes by an atomic flag, the rings only by the stopped sink thread.
+    m_priority.for_each_pending(write);
+#ifdef LOGGING_LOCK_FREE_QUEUE
+    if (sink_stopped) {
+      m_messages.for_each_pending(write);
+    }
+#else
+    m_messages.for_each_pending(write);
+#endif // LOGGING_LOCK_FREE_QUEUE
+    const staging_list* buffers = m_sink_buffers.load();
+    if (sink_stopped && buffers) {
+      for (auto& buffer : *buffers) {
+        buffer->for_each_pending(write);
+      }
+    }
+#endif //LOGGING_NO_THREAD
+    --m_crash_readers;
+#else
+    (void)fd;
+#endif //WIN32
+  }
+
+  std::chrono::steady_clock::time_point core::flush_all_sinks (flush_trigger trigger) {
+    std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+    return flush_sinks(*get_sinks(), trigger);
+  }
+
+  std::shared_ptr<const core::sink_list> core::get_sinks () const {
+    return std::atomic_load(&m_sinks);
+  }
+
+  void core::publish_sinks (std::shared_ptr<sink_list> sinks) {
+    std::vector<const void*> ids;
+    for (auto& s : *sinks) {
+      const void* id = formatter_id(s.m_formatter);
+      auto i = id ? std::find(ids.begin(), ids.end(), id) : ids.end();
+      if (i == ids.end()) {
+        s.m_render_slot = ids.size();
+        ids.push_back(id);
+      } else {
+        s.m_render_slot = static_cast<std::size_t>(i - ids.begin());
+      }
+    }
+    std::size_t targets = 0;
+    for (auto& s : *sinks) {
+      auto* buffer = s.m_stream ? dynamic_cast<durable_buffer*>(s.m_stream->rdbuf()) : nullptr;
+      if (buffer && (targets < LOGGING_MAX_CRASH_SINKS)) {
+        m_crash_targets[targets].m_level = s.m_level;
+        m_crash_targets[targets].m_buffer = buffer;
+        ++targets;
+      }
+    }
+    for (; targets < LOGGING_MAX_CRASH_SINKS; ++targets) {
+      m_crash_targets[targets].m_buffer = nullptr;
+    }
+    // a removed buffer may go away, when this returns.
+    while (m_crash_readers.load() > 0) {
+      std::this_thread::yield();
+    }
+    update_min_level(*sinks);
+    std::atomic_store(&m_sinks, std::shared_ptr<const sink_list>(std::move(sinks)));
   }
 
   void core::add_sink (std::ostream* stream,
                        level lvl,
-                       const record_formatter& formatter) {
+                       const record_formatter& formatter,
+                       const flush_policy& flush) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_sinks.push_back(sink(stream, lvl, formatter));
+    auto sinks = std::make_shared<sink_list>(*get_sinks());
+    sinks->push_back(sink(stream, lvl, formatter, flush));
+    publish_sinks(std::move(sinks));
   }
 
-  void core::remove_sink (std::ostream* stream) {
+  void core::add_async_sink (std::ostream* stream,
+                             level lvl,
+                             const record_formatter& formatter,
+                             const async_sink_options& options) {
+    sink s(stream, lvl, formatter);
+#ifndef LOGGING_NO_THREAD
+    s.m_worker = std::make_shared<async_sink_worker>(stream, formatter, options);
+#else
+    (void)options;
+#endif //LOGGING_NO_THREAD
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto sinks = std::make_shared<sink_list>(*get_sinks());
+    sinks->push_back(std::move(s));
+    publish_sinks(std::move(sinks));
+  }
+
+  void core::add_flight_recorder (const std::shared_ptr<flight_recorder>& recorder, level lvl) {
+    sink s(nullptr, lvl, recorder->formatter());
+    s.m_recorder = recorder;
     std::lock_guard<std::mutex> lock(m_mutex);
-    auto i = m_sinks.begin(), e = m_sinks.end();
-    i = std::find_if(i, e, [=](sink& s) { return s.m_stream == stream; });
-    if (i != e) {
-      m_sinks.erase(i);
+    auto sinks = std::make_shared<sink_list>(*get_sinks());
+    sinks->push_back(std::move(s));
+    publish_sinks(std::move(sinks));
+  }
+
+  void core::remove_flight_recorder (const std::shared_ptr<flight_recorder>& recorder) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto sinks = std::make_shared<sink_list>(*get_sinks());
+      auto i = std::find_if(sinks->begin(), sinks->end(), [&](const sink& s) { return s.m_recorder == recorder; });
+      if (i == sinks->end()) {
+        return;
+      }
+      sinks->erase(i);
+      publish_sinks(std::move(sinks));
+    }
+    // a running dispatch could still use the old snapshot, wait until it is done.
+    std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+  }
+
+  sink_stats core::get_sink_stats (std::ostream* stream) const {
+    const auto sinks = get_sinks();
+    for (auto& s : *sinks) {
+      if ((s.m_stream == stream) && s.m_worker) {
+        return s.m_worker->get_stats();
+      }
+    }
+    return sink_stats();
+  }
+
+  void core::remove_sink (std::ostream* stream) {
+    sink_list removed;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto sinks = std::make_shared<sink_list>(*get_sinks());
+      auto i = std::find_if(sinks->begin(), sinks->end(), [=](const sink& s) { return (s.m_stream == stream) && !s.m_recorder; });
+      if (i == sinks->end()) {
+        return;
+      }
+      removed.push_back(*i);
+      sinks->erase(i);
+      publish_sinks(std::move(sinks));
+    }
+    // a running dispatch could still use the old snapshot, wait until it is done.
+    {
+      std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+      flush_sinks(removed, flush_trigger::forced);
+    }
+    // other threads may still hold the old snapshot and the worker with it.
+    stop_async_sinks(removed);
+  }
+
+  void core::stop_async_sinks (const sink_list& sinks) {
+    for (auto& s : sinks) {
+      if (s.m_worker) {
+        s.m_worker->stop();
+      }
     }
   }
 
   void core::remove_all_sinks () {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_sinks.clear();
+    std::shared_ptr<const sink_list> removed;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      removed = get_sinks();
+      publish_sinks(std::make_shared<sink_list>());
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_dispatch_mutex);
+      flush_sinks(*removed, flush_trigger::forced);
+    }
+    stop_async_sinks(*removed);
   }
 
-  void core::set_thread_name (const char* name) {
-    t_thread_name = name;
+  unsigned int core::set_thread_name (const char* name) {
+    return thread_registry::set_current_name(name ? name : "");
   }
 
   core& core::instance() {
@@ -348,6 +1102,47 @@ namespace logging {
     }
   }
 
+  // ---------------------------------------------------------------------------
+  void core::rotate_file_with_max_count (const std::string& name,
+                                         const std::string& current,
+                                         int maxnum,
+                                         bool log_errors) {
+    auto report = [log_errors] (const std::exception& ex) {
+      std::ostringstream buf;
+      buf << "Exception in core::rotate_file_with_max_count:" << ex.what();
+      if (log_errors) {
+        instance().log(level::error, buf.str());
+      } else {
+        std::cerr << buf.str() << std::endl;
+      }
+    };
+    for (int i = maxnum - 1; i > 0; --i) {
+      try {
+        logging::rename_file_with_max_count(name, i, maxnum);
+      } catch (const std::exception& ex) {
+        report(ex);
+      }
+    }
+
+    std::string first_name = name;
+    std::string::size_type point_pos = first_name.rfind('.');
+    if (point_pos > 0) {
+      first_name.insert(point_pos, ".1");
+    } else {
+      first_name += ".1";
+    }
+
+    try {
+#ifdef USE_STD_FS
+      sys_fs::rename(sys_fs::path(current), sys_fs::path(first_name));
+#else
+      rename(current.c_str(), first_name.c_str());
+#endif
+    } catch (const std::exception& ex) {
+      report(ex);
+    }
+  }
+
   // ---------------------------------------------------------------------------
   std::string core::build_temp_log_file_name (const std::string& name) {
 #ifdef USE_STD_FS
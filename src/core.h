@@ -23,7 +23,9 @@
 #include <vector>
 #include <atomic>
 #include <functional>
+#include <future>
 #include <thread>
+#include <unordered_map>
 #if defined USE_MINGW && __MINGW_GCC_VERSION < 100000
 #include <mingw/mingw.thread.h>
 #endif
@@ -33,28 +35,130 @@
 // Library includes
 //
 #include "message_queue.h"
+#include "ring_queue.h"
+#include "staging_buffer.h"
+#include "async_sink.h"
+#include "durable_buffer.h"
+#include "flight_recorder.h"
+#include "render_buffer.h"
 #include "formatter.h"
 
 #ifdef WIN32
 #pragma warning (disable: 4251)
 #endif
 
+#ifndef LOGGING_MAX_CRASH_SINKS
+# define LOGGING_MAX_CRASH_SINKS 16
+#endif
+
+#ifndef LOGGING_EMERGENCY_WAIT_MS
+# define LOGGING_EMERGENCY_WAIT_MS 100
+#endif
+
 /**
 * Provides an API for stream logging to multiple sinks.
 */
 namespace logging {
 
+  /**
+    * How far the output of a sink is made durable.
+    * Syncing needs a stream buffer that implements durable_buffer,
+    * for other streams the sync modes only flush.
+    */
+  enum class durability {
+    /// leave the output in the stream buffer, flush only on core::flush, core::sync and removal.
+    none,
+    /// flush the stream to the kernel as given by the flush policy.
+    flush,
+    /// flush as given by the flush policy, sync when the oldest unsynced output is sync_interval old, also when idle.
+    periodic_sync,
+    /// flush as given by the flush policy, flush and sync after records of at least sync_level.
+    sync_on_level,
+    /// flush and sync once at the end of each batch, all records of a batch share the sync.
+    group_commit
+  };
+
+  /**
+    * When to flush the stream of a sink.
+    * The default flushes after every record. Otherwise the stream is flushed
+    * after a record of at least flush_level, when max_bytes are written
+    * since the last flush, at the end of a batch when the oldest unflushed
+    * record is older than max_delay, and when the sink thread goes idle.
+    * Without max_bytes and max_delay it is flushed at the end of each batch.
+    * The durability mode decides, if and when the output is synced to the
+    * storage device. Async sinks always flush after every record.
+    */
+  struct flush_policy {
+    level flush_level = level::undefined;
+    std::size_t max_bytes = 0;
+    std::chrono::milliseconds max_delay{0};
+
+    durability mode = durability::flush;
+    level sync_level = level::error;
+    std::chrono::milliseconds sync_interval{1000};
+
+    /// flush after every record.
+    static flush_policy every_record () {
+      return flush_policy();
+    }
+
+    /// flush in bulk, but at once on records of at least flush_level.
+    static flush_policy batched (std::size_t max_bytes = 0,
+                                 std::chrono::milliseconds max_delay = std::chrono::milliseconds(0),
+                                 level flush_level = level::error) {
+      flush_policy p;
+      p.flush_level = flush_level;
+      p.max_bytes = max_bytes;
+      p.max_delay = max_delay;
+      return p;
+    }
+
+    /// flush in bulk and sync as given by the durability mode.
+    static flush_policy durable (durability mode,
+                                 level sync_level = level::error,
+                                 std::chrono::milliseconds sync_interval = std::chrono::milliseconds(1000)) {
+      flush_policy p = batched();
+      p.mode = mode;
+      p.sync_level = sync_level;
+      p.sync_interval = sync_interval;
+      return p;
+    }
+  };
+
   /**
     * Sink description with target ostream, level to log and log record formatter
     */
   struct LOGGING_EXPORT sink {
     sink (std::ostream* stream,
           level lvl,
-          const record_formatter& formatter);
+          const record_formatter& formatter,
+          const flush_policy& flush = flush_policy());
 
     std::ostream* m_stream;
     level m_level;
     record_formatter m_formatter;
+    flush_policy m_flush;
+
+    /// output written since the last flush, shared by all snapshots of the sink list.
+    struct pending_output {
+      std::size_t m_bytes = 0;
+      std::chrono::steady_clock::time_point m_since;
+      bool m_unsynced = false;
+      std::chrono::steady_clock::time_point m_unsynced_since;
+      /// output a durable buffer may keep back since the last flush_pending, tracked with a max_delay only.
+      bool m_kept = false;
+      std::chrono::steady_clock::time_point m_kept_since;
+    };
+    std::shared_ptr<pending_output> m_pending;
+
+    /// sinks with the same formatter function share one rendered record, assigned when the sinks are published.
+    std::size_t m_render_slot = 0;
+
+    /// own queue and thread of an async sink, else null.
+    std::shared_ptr<async_sink_worker> m_worker;
+
+    /// ring of a flight recorder sink, else null. Such a sink has no stream.
+    std::shared_ptr<flight_recorder> m_recorder;
   };
 
   /**
@@ -71,19 +175,71 @@ namespace logging {
     /// finish the logging core
     void finish ();
 
-    /// flush cashed entries to the sinks
+    /// flush cashed entries to the sinks, sinks with unsynced output of a sync mode are synced too
     void flush ();
 
-    /// add a log entry with current time point to the cache
-    void log (level lvl, std::string&& message);
-
-    /// add a log entry with specific time point to the cache
-    void log (level lvl, std::chrono::system_clock::time_point time_point, std::string&& message);
+    /// flush cashed entries to the sinks and sync all sinks with a durability mode to the storage device
+    void sync ();
+
+    /**
+     * write the pending records of the queues and staging buffers to the files
+     * of the sinks and to fd. Uses only async-signal-safe operations and never
+     * waits for a lock, for crash handlers. The records stay in the queues.
+     * The sink thread is stopped first, it waits up to LOGGING_EMERGENCY_WAIT_MS
+     * for it to reach a record boundary. Then the batch it is writing is included
+     * from its current record on, as well as the staging buffers and the lock free
+     * queue. If it does not stop in time, only the locked queues are written.
+     * The core writes no more records to the sinks afterwards.
+     */
+    void emergency_drain (int fd = -1);
 
-    /// add a sink with a formatter
-    void add_sink (std::ostream* stream, level lvl, const record_formatter& formatter);
-
-    /// remove a sink
+    /// add a log entry with current time point to the cache
+    void log (level lvl, std::string_view message);
+
+    /// add a log entry with specific time point and encoded structured fields to the cache
+    void log (level lvl, std::chrono::system_clock::time_point time_point, std::string_view message,
+              std::string_view fields = std::string_view());
+
+    /// add a log entry with current time point, a registered format and its encoded arguments to the cache
+    void log_deferred (level lvl, std::uint32_t format_id, std::string_view args);
+
+    /**
+     * add a log entry with specific time point to the priority lane of the cache.
+     * The returned future becomes ready, when the entry is written and flushed to the sinks,
+     * async sinks included. It holds an exception, if an async sink did not write it in time.
+     */
+    std::future<void> log_persisted (level lvl, std::chrono::system_clock::time_point time_point, std::string_view message,
+                                     std::string_view fields = std::string_view());
+
+    /// add a sink with a formatter and a flush policy
+    void add_sink (std::ostream* stream, level lvl, const record_formatter& formatter,
+                   const flush_policy& flush = flush_policy());
+
+    /**
+     * add a sink with an own queue and worker thread, so a slow sink does not delay the other sinks.
+     * If a write exceeds the budget of the options, the sink is degraded and its queue is limited.
+     */
+    void add_async_sink (std::ostream* stream, level lvl, const record_formatter& formatter,
+                         const async_sink_options& options = async_sink_options());
+
+    /**
+     * add a flight recorder, that keeps the most recent records of at least lvl.
+     * The recorder is not limited by the global log level, it is dumped when
+     * a fatal record arrives.
+     */
+    void add_flight_recorder (const std::shared_ptr<flight_recorder>& recorder, level lvl = level::trace);
+
+    /// remove a flight recorder, it is no longer used by the core when it returns.
+    void remove_flight_recorder (const std::shared_ptr<flight_recorder>& recorder);
+
+    /// write statistics of an async sink, empty statistics for other sinks
+    sink_stats get_sink_stats (std::ostream* stream) const;
+
+    /**
+     * remove a sink, an async sink writes its pending records before.
+     * When it returns, the stream is no longer used by the core.
+     * Must not be called from a formatter.
+     */
     void remove_sink (std::ostream* stream);
 
     /// remove all sinks
@@ -95,6 +251,32 @@ namespace logging {
     /// get the global log level
     level get_log_level () const;
 
+    /// return true if a record of level lvl will be consumed by any sink, false for all levels without sinks
+    bool is_enabled (level lvl) const;
+
+    /**
+     * Let each logging thread write into an own staging buffer,
+     * that is drained by the sink thread, instead of the shared queue.
+     */
+    void set_staging (bool enable);
+
+    /// return true if logging threads use staging buffers
+    bool get_staging () const;
+
+    /**
+     * limit the records and bytes waiting for the sink thread and set the overflow policy.
+     * The priority lane of errors has the same limits on its own. It never drops
+     * queued records, drop_oldest drops the new error instead, and persisted records
+     * always wait for room.
+     */
+    void set_queue_limits (const queue_limits& limits);
+
+    /// get the queue limits and the overflow policy
+    queue_limits get_queue_limits () const;
+
+    /// number of records of level lvl, that were dropped due to the queue limits, including the priority lane
+    std::size_t get_dropped_count (level lvl) const;
+
     /// get a standard formatter
     static record_formatter get_standard_formatter ();
 
@@ -110,11 +292,18 @@ namespace logging {
     /// helper to rename files with a number and a given maximum number
     static void rename_file_with_max_count (const std::string& name, int maxnum);
 
+    /**
+     * helper to shift the numbered files like rename_file_with_max_count and move current to number 1.
+     * Errors are logged, or written to std::cerr if log_errors is false, e.g. while a sink is written.
+     */
+    static void rotate_file_with_max_count (const std::string& name, const std::string& current, int maxnum,
+                                            bool log_errors = true);
+
     /// helper to build a temporary file name
     static std::string build_temp_log_file_name (const std::string& name);
 
-    /// Thread name. Thread specific variable to hold the name of the thread.
-    static void set_thread_name (const char* name);
+    /// Thread name. Registers the name of the current thread once and returns its id.
+    static unsigned int set_thread_name (const char* name);
 
     core (const core&) = delete;
     void operator= (const core&) = delete;
@@ -123,23 +312,160 @@ namespace logging {
     friend class record;
 
   private:
+    typedef std::vector<std::shared_ptr<staging_buffer>> staging_list;
+    typedef std::vector<sink> sink_list;
+
     static void logging_sink_call (core* core);
 
     void log_to_sinks (record&& entry);
 
-    level m_level;
+    /// write a batch of records under one lock of the sink list.
+    void log_to_sinks (const std::vector<record>& batch);
+
+    /// publish the records written by the dispatch for emergency_drain, null when done, needs the dispatch lock.
+    void set_in_flight (const record* records, std::size_t count);
+
+    /// stop the sink thread for emergency_drain, returns when the core finishes.
+    void park_for_emergency ();
+
+    /// write one record to all sinks, stream sinks also need global_lvl, needs the dispatch lock.
+    void write_to_sinks (const sink_list& sinks, const record& entry, level global_lvl);
+
+    /// why the sinks are flushed.
+    enum class flush_trigger {
+      /// end of a batch, flush the sinks due by their flush policy.
+      batch,
+      /// the sink thread goes idle, flush all sinks with pending output.
+      idle,
+      /// flush requested explicit or on removal, the buffers also write out what they keep back.
+      forced
+    };
+
+    /**
+     * flush the sinks as demanded by the trigger, a forced flush also syncs sinks with a sync mode.
+     * Output kept back by a durable buffer is written by force max_delay after it was written.
+     * Returns the time of the next periodic sync or delayed flush, max if none is pending. Needs the dispatch lock.
+     */
+    std::chrono::steady_clock::time_point flush_sinks (const sink_list& sinks, flush_trigger trigger);
+
+    /// flush the sink and sync it to the storage device, needs the dispatch lock.
+    void sync_sink (const sink& s);
+
+    /// flush all sinks with pending output, returns the time of the next periodic sync or delayed flush.
+    std::chrono::steady_clock::time_point flush_all_sinks (flush_trigger trigger = flush_trigger::forced);
+
+    /// current snapshot of the sinks.
+    std::shared_ptr<const sink_list> get_sinks () const;
+
+    /// write the pending records of removed async sinks and join their workers.
+    void stop_async_sinks (const sink_list& sinks);
+
+    /// assign the render slots and replace the snapshot of the sinks, needs the sink lock.
+    void publish_sinks (std::shared_ptr<sink_list> sinks);
+
+    /// move the record into the staging buffer of the current thread, return false if not possible.
+    bool enqueue_staged (record& entry);
+
+    /// copy the registered staging buffers and remove abandoned empty ones, returns the registry version.
+    unsigned int update_staging (staging_list& buffers);
+
+    /// collect pending records from the queue and the staging buffers, ordered by line id.
+    void collect (std::vector<record>& batch, const staging_list& buffers);
+
+    /// waits until queue and staging buffers are empty for maximum timeout time span.
+    void wait_until_empty (const std::chrono::milliseconds& timeout);
+
+    /// waits until the queues of the async sinks are empty for maximum timeout time span.
+    void wait_for_async_sinks (const std::chrono::milliseconds& timeout);
+
+    /// waits until the async sinks taking records of level lvl wrote their queues, returns false on timeout.
+    bool wait_for_async_sinks (level lvl, const std::chrono::milliseconds& timeout);
+
+    /// recalculate the minimum level consumed by the sinks, needs the sink lock.
+    void update_min_level (const sink_list& sinks);
+
+    /// log a summary of the records dropped since the last report.
+    void report_dropped (drop_counter::counts& reported);
+
+    /// records dropped by the queue and the priority lane per level.
+    drop_counter::counts dropped_counts () const;
+
+    /// pass a new record to the queues or directly to the sinks.
+    void dispatch (record&& entry);
+
+    /// write the records of the priority lane, return false if there were none.
+    bool log_priority (std::vector<record>& batch);
+
+    std::atomic<level> m_level;
+
+    /// max of the global level and the lowest sink level.
+    std::atomic<level> m_min_level;
 
     volatile bool m_is_active;
     std::atomic_uint m_line_id{};
 
+    /// serializes changes of the sinks, never taken to write records.
     std::mutex m_mutex;
-    typedef std::vector<sink> sink_list;
 
-    sink_list m_sinks;
+    /// immutable snapshot of the sinks, replaced by add and remove.
+    std::shared_ptr<const sink_list> m_sinks;
+
+    /// taken while records are written to the sinks.
+    std::mutex m_dispatch_mutex;
+
+    /// file buffers of the sinks for emergency_drain, updated when the sinks are published.
+    struct crash_target {
+      std::atomic<durable_buffer*> m_buffer{nullptr};
+      std::atomic<level> m_level{level::undefined};
+    };
+    crash_target m_crash_targets[LOGGING_MAX_CRASH_SINKS];
+
+    /// records written by the dispatch right now, the index of the current one and the writing thread, for emergency_drain.
+    std::atomic<const record*> m_in_flight{nullptr};
+    std::atomic<std::size_t> m_in_flight_size{0};
+    std::atomic<std::size_t> m_in_flight_index{0};
+    std::atomic<std::thread::id> m_in_flight_thread{std::thread::id()};
+
+    /// set by emergency_drain, the sink thread stops at the next record boundary.
+    std::atomic_bool m_emergency{false};
+
+    /// number of emergency drains using the crash targets, publishing the sinks waits for them.
+    std::atomic_int m_crash_readers{0};
+
+    /// render targets of the records per render slot, need the dispatch lock.
+    std::vector<std::unique_ptr<render_stream>> m_renders;
+    std::vector<bool> m_rendered;
 
 #ifndef LOGGING_NO_THREAD
-    message_queue m_messages;
+#ifdef LOGGING_LOCK_FREE_QUEUE
+    typedef ring_queue queue_type;
+#else
+    typedef message_queue queue_type;
+#endif // LOGGING_LOCK_FREE_QUEUE
+
+    queue_type m_messages;
     std::thread m_sink_thread;
+
+    /// lane for error records and persisted records, served first, limited like the queue.
+    message_queue m_priority;
+
+    /// promises of persisted records by line id.
+    std::mutex m_persist_mutex;
+    std::unordered_map<unsigned int, std::promise<void>> m_persist_promises;
+    std::atomic_uint m_persist_count{0};
+
+    std::atomic_bool m_sink_idle{false};
+
+    /// set by the sink thread, when it stopped for emergency_drain.
+    std::atomic_bool m_sink_parked{false};
+
+    /// staging buffers the sink thread reads, stable while it is idle or parked.
+    std::atomic<const staging_list*> m_sink_buffers{nullptr};
+
+    std::atomic_bool m_use_staging{false};
+    std::atomic_uint m_staging_version{0};
+    std::mutex m_staging_mutex;
+    staging_list m_staging;
 #endif //LOGGING_NO_THREAD
   };
 
@@ -20,11 +20,17 @@ namespace logging {
 
   inline sink::sink (std::ostream* stream,
                      level lvl,
-                     const record_formatter& formatter)
+                     const record_formatter& formatter,
+                     const flush_policy& flush)
     : m_stream(stream)
     , m_level(lvl)
     , m_formatter(formatter)
+    , m_flush(flush)
+    , m_pending(std::make_shared<pending_output>())
   {}
 
+  inline bool core::is_enabled (level lvl) const {
+    return lvl >= m_min_level.load(std::memory_order_relaxed);
+  }
 
 } // namespace logging
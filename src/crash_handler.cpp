@@ -0,0 +1,267 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "crash_handler.h"
+#include "core.h"
+
+
+namespace logging {
+
+  namespace {
+
+    const int s_crash_signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    constexpr std::size_t s_crash_signal_count = sizeof(s_crash_signals) / sizeof(s_crash_signals[0]);
+
+    const char* s_level_names[] = {
+      "undef", "trace", "debug", "info ", "warn ", "error", "fatal"
+    };
+
+    struct sigaction s_previous[s_crash_signal_count];
+    bool s_installed = false;
+
+    /// alternate signal stack, so a stack overflow can still run the handler.
+    constexpr std::size_t s_alt_stack_size = 64 * 1024;
+    void* s_alt_stack = nullptr;
+
+    /// set up before the handler is installed, only read in the handler.
+    core* s_core = nullptr;
+    int s_extra_fd = -1;
+
+    std::atomic_bool s_crashed{false};
+
+    void release_alt_stack () {
+      if (s_alt_stack) {
+        stack_t alt;
+        std::memset(&alt, 0, sizeof(alt));
+        alt.ss_flags = SS_DISABLE;
+        sigaltstack(&alt, nullptr);
+        std::free(s_alt_stack);
+        s_alt_stack = nullptr;
+      }
+    }
+
+    void crash_handler (int sig) {
+      // only the first crashing thread drains, a crash in the drain ends with the previous handler.
+      if (!s_crashed.exchange(true)) {
+        const int saved_errno = errno;
+        for (std::size_t i = 0; i < s_crash_signal_count; ++i) {
+          sigaction(s_crash_signals[i], &s_previous[i], nullptr);
+        }
+        s_core->emergency_drain(s_extra_fd);
+        errno = saved_errno;
+      } else {
+        for (std::size_t i = 0; i < s_crash_signal_count; ++i) {
+          if (s_crash_signals[i] == sig) {
+            sigaction(sig, &s_previous[i], nullptr);
+          }
+        }
+      }
+      // delivered with the previous handler, when this one returns.
+      raise(sig);
+    }
+
+  } // namespace
+
+  bool install_crash_handler (const crash_handler_options& options) {
+    if (s_installed) {
+      return true;
+    }
+    s_core = &core::instance();
+    s_extra_fd = options.fd;
+    s_crashed = false;
+
+    // keep an alternate stack the thread already has.
+    stack_t current;
+    if ((sigaltstack(nullptr, &current) == 0) && (current.ss_flags & SS_DISABLE)) {
+      const std::size_t size = std::max<std::size_t>(s_alt_stack_size, SIGSTKSZ);
+      s_alt_stack = std::malloc(size);
+      if (s_alt_stack) {
+        stack_t alt;
+        std::memset(&alt, 0, sizeof(alt));
+        alt.ss_sp = s_alt_stack;
+        alt.ss_size = size;
+        if (sigaltstack(&alt, nullptr) != 0) {
+          std::free(s_alt_stack);
+          s_alt_stack = nullptr;
+        }
+      }
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = crash_handler;
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+
+    for (std::size_t i = 0; i < s_crash_signal_count; ++i) {
+      if (sigaction(s_crash_signals[i], &action, &s_previous[i]) != 0) {
+        while (i-- > 0) {
+          sigaction(s_crash_signals[i], &s_previous[i], nullptr);
+        }
+        release_alt_stack();
+        return false;
+      }
+    }
+    s_installed = true;
+    return true;
+  }
+
+  void uninstall_crash_handler () {
+    if (!s_installed) {
+      return;
+    }
+    for (std::size_t i = 0; i < s_crash_signal_count; ++i) {
+      sigaction(s_crash_signals[i], &s_previous[i], nullptr);
+    }
+    release_alt_stack();
+    s_installed = false;
+  }
+
+  // --------------------------------------------------------------------------
+  emergency_writer::emergency_writer ()
+    : m_fd_count(0)
+    , m_target_count(0)
+    , m_size(0)
+    , m_count(0)
+  {}
+
+  bool emergency_writer::add (int fd, level lvl) {
+    if (fd < 0) {
+      return true;
+    }
+    for (std::size_t i = 0; i < m_fd_count; ++i) {
+      if (m_fds[i] == fd) {
+        // the same file for several sinks, write it once with the lowest level.
+        m_levels[i] = (lvl < m_levels[i]) ? lvl : m_levels[i];
+        return true;
+      }
+    }
+    if (m_fd_count == max_fds) {
+      return false;
+    }
+    m_fds[m_fd_count] = fd;
+    m_levels[m_fd_count] = lvl;
+    ++m_fd_count;
+    return true;
+  }
+
+  void emergency_writer::write (const record& entry) {
+    m_target_count = 0;
+    for (std::size_t i = 0; i < m_fd_count; ++i) {
+      if (entry.level() >= m_levels[i]) {
+        m_targets[m_target_count++] = m_fds[i];
+      }
+    }
+    if (m_target_count == 0) {
+      return;
+    }
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(entry.time_point().time_since_epoch()).count();
+    const auto lvl = static_cast<std::size_t>(entry.level());
+
+    m_size = 0;
+    append(entry.line().n, 4);
+    append("|");
+    append(static_cast<std::uint64_t>(us / 1000000), 1);
+    append(".");
+    append(static_cast<std::uint64_t>(us % 1000000), 6);
+    append("|");
+    append(lvl < sizeof(s_level_names) / sizeof(s_level_names[0]) ? s_level_names[lvl] : "undef");
+    append("|");
+    append(entry.thread_name());
+    append("|");
+    append(entry.format_id() ? format_registry::format(entry.format_id()) : entry.message());
+    append("\n");
+    flush();
+    ++m_count;
+  }
+
+  std::size_t emergency_writer::count () const {
+    return m_count;
+  }
+
+  void emergency_writer::append (std::string_view text) {
+    while (!text.empty()) {
+      if (m_size == sizeof(m_buffer)) {
+        flush();
+      }
+      const std::size_t n = std::min(text.size(), sizeof(m_buffer) - m_size);
+      std::memcpy(m_buffer + m_size, text.data(), n);
+      m_size += n;
+      text.remove_prefix(n);
+    }
+  }
+
+  void emergency_writer::append (std::uint64_t value, int width) {
+    char digits[20];
+    int n = 0;
+    do {
+      digits[n++] = static_cast<char>('0' + (value % 10));
+      value /= 10;
+    } while ((value > 0) && (n < 20));
+    char text[20];
+    int len = 0;
+    for (int i = n; i < width; ++i) {
+      text[len++] = '0';
+    }
+    while (n > 0) {
+      text[len++] = digits[--n];
+    }
+    append(std::string_view(text, static_cast<std::size_t>(len)));
+  }
+
+  void emergency_writer::flush () {
+    for (std::size_t i = 0; i < m_target_count; ++i) {
+      const char* data = m_buffer;
+      std::size_t left = m_size;
+      while (left > 0) {
+        const ssize_t written = ::write(m_targets[i], data, left);
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          break;
+        }
+        data += written;
+        left -= static_cast<std::size_t>(written);
+      }
+    }
+    m_size = 0;
+  }
+
+} // namespace logging
+
+#endif // WIN32
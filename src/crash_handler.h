@@ -0,0 +1,107 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+
+#pragma once
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Options of the crash handler.
+    */
+  struct crash_handler_options {
+    /// additional descriptor for the drained records, e.g. 2 for stderr, -1 for none.
+    int fd = 2;
+  };
+
+  /**
+    * Install an opt-in handler for SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT.
+    * On a crash it drains the pending records of the core to the file sinks
+    * with core::emergency_drain, restores the previous handler and re-raises
+    * the signal. An alternate signal stack is registered for the calling thread,
+    * if it has none, so a stack overflow in this thread still runs the handler.
+    * Returns false, if a handler could not be installed.
+    */
+  LOGGING_EXPORT bool install_crash_handler (const crash_handler_options& options = crash_handler_options());
+
+  /// restore the handlers that were active before install_crash_handler.
+  LOGGING_EXPORT void uninstall_crash_handler ();
+
+  /**
+    * Renders records into a fixed buffer and writes them with write(2).
+    * Only uses async-signal-safe operations and never allocates.
+    * The records are written as "line|seconds.microseconds|level|thread|message",
+    * the time is the unix time, since local time is not available in a signal handler.
+    * Structured fields and the arguments of deferred formats are left out.
+    */
+  class LOGGING_EXPORT emergency_writer {
+  public:
+    emergency_writer ();
+
+    /// write records of at least lvl to fd, returns false if the table is full.
+    bool add (int fd, level lvl);
+
+    /// render the record and write it to all descriptors of its level.
+    void write (const record& entry);
+
+    /// number of records written.
+    std::size_t count () const;
+
+    emergency_writer (const emergency_writer&) = delete;
+    void operator= (const emergency_writer&) = delete;
+
+  private:
+    void append (std::string_view text);
+    void append (std::uint64_t value, int width);
+    void flush ();
+
+    static constexpr std::size_t max_fds = LOGGING_MAX_CRASH_SINKS + 1;
+
+    int m_fds[max_fds];
+    level m_levels[max_fds];
+    std::size_t m_fd_count;
+
+    /// descriptors of the current record.
+    int m_targets[max_fds];
+    std::size_t m_target_count;
+
+    char m_buffer[1024];
+    std::size_t m_size;
+    std::size_t m_count;
+  };
+
+} // namespace logging
+
+#endif // WIN32
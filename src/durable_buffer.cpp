@@ -0,0 +1,101 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <fcntl.h>
+#ifdef WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "durable_buffer.h"
+
+
+namespace logging {
+
+  durable_buffer::~durable_buffer () = default;
+
+  bool durable_buffer::flush_pending () {
+    return true;
+  }
+
+  int durable_buffer::emergency_fd () const {
+    return -1;
+  }
+
+  bool durable_buffer::sync_file (int fd) {
+    if (fd < 0) {
+      return false;
+    }
+#ifdef WIN32
+    return _commit(fd) == 0;
+#elif defined __linux__
+    return fdatasync(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+  }
+
+  durable_filebuf::durable_filebuf ()
+    : m_fd(-1)
+  {}
+
+  durable_filebuf::~durable_filebuf () {
+    close();
+  }
+
+  durable_filebuf* durable_filebuf::open (const std::string& name, std::ios_base::openmode mode) {
+    close();
+    if (!std::filebuf::open(name, mode)) {
+      return nullptr;
+    }
+#ifdef WIN32
+    m_fd = _open(name.c_str(), _O_WRONLY | _O_APPEND);
+#else
+    m_fd = ::open(name.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+#endif
+    return this;
+  }
+
+  durable_filebuf* durable_filebuf::close () {
+    if (m_fd >= 0) {
+#ifdef WIN32
+      _close(m_fd);
+#else
+      ::close(m_fd);
+#endif
+      m_fd = -1;
+    }
+    return std::filebuf::close() ? this : nullptr;
+  }
+
+  bool durable_filebuf::sync_to_storage () {
+    return (pubsync() == 0) && sync_file(m_fd);
+  }
+
+  int durable_filebuf::emergency_fd () const {
+    return m_fd;
+  }
+
+} // namespace logging
@@ -0,0 +1,82 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <fstream>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "logging-export.h"
+
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Interface of stream buffers, that can write their output through to the
+    * storage device. Used by the logging core for the durability of a sink.
+    */
+  class LOGGING_EXPORT durable_buffer {
+  public:
+    virtual ~durable_buffer ();
+
+    /// sync the flushed output to the storage device, returns false on error.
+    virtual bool sync_to_storage () = 0;
+
+    /**
+     * write out data kept back on normal flushes, e.g. a partial compressed block.
+     * Called on forced flushes and, if the flush policy has a max_delay, max_delay after the first kept output.
+     */
+    virtual bool flush_pending ();
+
+    /// descriptor a crash handler can append raw text to, -1 if the file can not take it.
+    virtual int emergency_fd () const;
+
+    /// sync the data of the file descriptor (fdatasync where available).
+    static bool sync_file (int fd);
+  };
+
+  /**
+    * File buffer with a second descriptor of the file to sync it.
+    * The descriptor appends, so a crash handler can write to it.
+    */
+  class LOGGING_EXPORT durable_filebuf : public std::filebuf, public durable_buffer {
+  public:
+    durable_filebuf ();
+    ~durable_filebuf ();
+
+    durable_filebuf* open (const std::string& name, std::ios_base::openmode mode);
+    durable_filebuf* close ();
+
+    bool sync_to_storage () override;
+
+    int emergency_fd () const override;
+
+  private:
+    int m_fd;
+  };
+
+} // namespace logging
@@ -0,0 +1,203 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cmath>
+#include <cstring>
+#include <ostream>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "fields.h"
+
+
+namespace logging {
+
+  /*
+   * Encoding of one field:
+   * type (1 byte), key size (1 byte), key,
+   * int64 / float64: 8 bytes, boolean: 1 byte, string: size (4 bytes) and text.
+   * Numbers are stored in host byte order.
+   */
+
+  namespace {
+
+    template <typename T>
+    inline void append (std::string& data, const T& value) {
+      data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline bool take (std::string_view& data, T& value) {
+      if (data.size() < sizeof(T)) {
+        return false;
+      }
+      std::memcpy(&value, data.data(), sizeof(T));
+      data.remove_prefix(sizeof(T));
+      return true;
+    }
+
+    void print_json_string (std::ostream& out, std::string_view str) {
+      static const char hex[] = "0123456789abcdef";
+      out << '"';
+      for (const char ch : str) {
+        switch (ch) {
+          case '"':  out << "\\\""; break;
+          case '\\': out << "\\\\"; break;
+          case '\n': out << "\\n"; break;
+          case '\r': out << "\\r"; break;
+          case '\t': out << "\\t"; break;
+          default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+              out << "\\u00" << hex[(ch >> 4) & 0xF] << hex[ch & 0xF];
+            } else {
+              out << ch;
+            }
+            break;
+        }
+      }
+      out << '"';
+    }
+
+  } // namespace
+
+  std::string_view char_string (char c) {
+    static const struct char_table {
+      char_table () {
+        for (int i = 0; i < 256; ++i) {
+          chars[i] = static_cast<char>(i);
+        }
+      }
+      char chars[256];
+    } table;
+    return std::string_view(&table.chars[static_cast<unsigned char>(c)], 1);
+  }
+
+  void encode_field (std::string& data, const field& f) {
+    data.push_back(static_cast<char>(f.m_type));
+    data.push_back(static_cast<char>(f.m_key.size()));
+    data.append(f.m_key.data(), f.m_key.size());
+    switch (f.m_type) {
+      case field_type::int64:
+        append(data, f.m_int);
+        break;
+      case field_type::float64:
+        append(data, f.m_double);
+        break;
+      case field_type::boolean:
+        data.push_back(f.m_int ? 1 : 0);
+        break;
+      case field_type::string:
+        append(data, static_cast<std::uint32_t>(f.m_string.size()));
+        data.append(f.m_string.data(), f.m_string.size());
+        break;
+    }
+  }
+
+  bool decode_field (std::string_view& data, field& f) {
+    std::uint8_t type = 0, key_size = 0;
+    if (!take(data, type) || !take(data, key_size) || (data.size() < key_size)) {
+      return false;
+    }
+    f.m_type = static_cast<field_type>(type);
+    f.m_key = data.substr(0, key_size);
+    data.remove_prefix(key_size);
+    switch (f.m_type) {
+      case field_type::int64:
+        return take(data, f.m_int);
+      case field_type::float64:
+        return take(data, f.m_double);
+      case field_type::boolean: {
+        std::uint8_t b = 0;
+        const bool ok = take(data, b);
+        f.m_int = b;
+        return ok;
+      }
+      case field_type::string: {
+        std::uint32_t size = 0;
+        if (!take(data, size) || (data.size() < size)) {
+          return false;
+        }
+        f.m_string = data.substr(0, size);
+        data.remove_prefix(size);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::ostream& operator << (std::ostream& out, const field& f) {
+    switch (f.m_type) {
+      case field_type::int64:   out << f.m_int; break;
+      case field_type::float64: out << f.m_double; break;
+      case field_type::boolean: out << (f.m_int ? "true" : "false"); break;
+      case field_type::string:  out << f.m_string; break;
+    }
+    return out;
+  }
+
+  void print_fields (std::ostream& out, std::string_view data) {
+    bool first = true;
+    for_each_field(data, [&] (const field& f) {
+      if (!first) {
+        out << ' ';
+      }
+      first = false;
+      out << f.m_key << '=' << f;
+    });
+  }
+
+  void print_fields_json (std::ostream& out, std::string_view data) {
+    bool first = true;
+    out << '{';
+    for_each_field(data, [&] (const field& f) {
+      if (!first) {
+        out << ',';
+      }
+      first = false;
+      print_json_string(out, f.m_key);
+      out << ':';
+      if (f.m_type == field_type::string) {
+        print_json_string(out, f.m_string);
+      } else if ((f.m_type == field_type::float64) && !std::isfinite(f.m_double)) {
+        // json has no nan or infinity.
+        out << "null";
+      } else {
+        out << f;
+      }
+    });
+    out << '}';
+  }
+
+  void print_formatted (std::ostream& out, std::string_view format, std::string_view args) {
+    field f;
+    std::size_t start = 0;
+    for (std::size_t i = format.find("{}"); i != std::string_view::npos; i = format.find("{}", start)) {
+      out << format.substr(start, i - start);
+      if (decode_field(args, f)) {
+        out << f;
+      }
+      start = i + 2;
+    }
+    out << format.substr(start);
+  }
+
+} // namespace logging
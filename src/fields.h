@@ -0,0 +1,130 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "logging-export.h"
+
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Type of a structured field.
+    */
+  enum class field_type : std::uint8_t {
+    int64, float64, boolean, string
+  };
+
+  /**
+    * Typed key/value field of a record.
+    * The field only refers to key and string value, it does not copy them.
+    * The key is limited to 255 characters.
+    * A char is stored as one character string, signed and unsigned char as integer.
+    */
+  struct field {
+    template <typename T>
+    field (std::string_view key, const T& value);
+
+    field ();
+
+    std::string_view m_key;
+    field_type m_type;
+    std::int64_t m_int;
+    double m_double;
+    std::string_view m_string;
+  };
+
+  /// append the encoded field to data.
+  LOGGING_EXPORT void encode_field (std::string& data, const field& f);
+
+  /// decode the next field and remove it from data, returns false at the end.
+  LOGGING_EXPORT bool decode_field (std::string_view& data, field& f);
+
+  /// print the encoded fields as "key=value key=value".
+  LOGGING_EXPORT void print_fields (std::ostream& out, std::string_view data);
+
+  /// print the encoded fields as json object, nan and infinity as null.
+  LOGGING_EXPORT void print_fields_json (std::ostream& out, std::string_view data);
+
+  /// print the format with each "{}" replaced by the next encoded argument.
+  LOGGING_EXPORT void print_formatted (std::ostream& out, std::string_view format, std::string_view args);
+
+  /// one character string of c that stays valid, a char field refers to it.
+  LOGGING_EXPORT std::string_view char_string (char c);
+
+  /// convenience stream operator to print the value of a field to ostream.
+  LOGGING_EXPORT std::ostream& operator << (std::ostream& out, const field& f);
+
+  /// call fn for each encoded field.
+  template <typename F>
+  void for_each_field (std::string_view data, F fn) {
+    field f;
+    while (decode_field(data, f)) {
+      fn(f);
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  inline field::field ()
+    : m_type(field_type::int64)
+    , m_int(0)
+    , m_double(0)
+  {}
+
+  template <typename T>
+  inline field::field (std::string_view key, const T& value)
+    : m_key(key.substr(0, 255))
+    , m_type(field_type::int64)
+    , m_int(0)
+    , m_double(0)
+  {
+    if constexpr (std::is_same_v<T, bool>) {
+      m_type = field_type::boolean;
+      m_int = value ? 1 : 0;
+    } else if constexpr (std::is_same_v<T, char>) {
+      m_type = field_type::string;
+      m_string = char_string(value);
+    } else if constexpr (std::is_integral_v<T>) {
+      m_type = field_type::int64;
+      m_int = static_cast<std::int64_t>(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+      m_type = field_type::float64;
+      m_double = static_cast<double>(value);
+    } else {
+      static_assert(std::is_convertible_v<const T&, std::string_view>, "field value must be a number, bool or string");
+      m_type = field_type::string;
+      m_string = value;
+    }
+  }
+
+} // namespace logging
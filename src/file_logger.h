@@ -30,19 +30,22 @@ namespace logging {
   */
   class file_logger {
   public:
-    file_logger (const std::string& name, level lvl, const record_formatter& fmt)
-      : file(name, std::ios_base::out|std::ios_base::ate)
+    file_logger (const std::string& name, level lvl, const record_formatter& fmt,
+                 const flush_policy& flush = flush_policy())
+      : file(&buffer)
     {
-      core::instance().add_sink(&file, lvl, fmt);
+      buffer.open(name, std::ios_base::out|std::ios_base::ate);
+      core::instance().add_sink(&file, lvl, fmt, flush);
     }
 
     ~file_logger () {
       core::instance().remove_sink(&file);
-      file.close();
+      buffer.close();
     }
 
   private:
-    std::ofstream file;
+    durable_filebuf buffer;
+    std::ostream file;
   };
 
 } // namespace logging
@@ -0,0 +1,155 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "flight_recorder.h"
+#include "ring_queue.h"
+
+
+namespace logging {
+
+  flight_recorder::flight_recorder (std::size_t capacity,
+                                    const std::string& dump_file,
+                                    const record_formatter& formatter)
+    : m_slots(new slot[round_up_pow2(capacity)])
+    , m_mask(round_up_pow2(capacity) - 1)
+    , m_head(0)
+    , m_dump_file(dump_file)
+    , m_formatter(formatter)
+  {}
+
+  void flight_recorder::add (const record& entry) {
+    const std::uint64_t pos = m_head.load(std::memory_order_relaxed);
+    slot& s = m_slots[pos & m_mask];
+    s.m_sequence.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if ((entry.message().size() + entry.fields().size()) <= record::inline_size) {
+      store(s, entry, entry.message(), entry.fields(), entry.format_id());
+    } else {
+      m_render.clear();
+      fmt::message(m_render, entry);
+      // a large record keeps its formatted message, truncated to fit inline.
+      store(s, entry, std::string_view(m_render.data(), std::min(m_render.size(), record::inline_size)),
+            std::string_view(), 0);
+    }
+
+    s.m_sequence.store(2 * pos + 2, std::memory_order_release);
+    m_head.store(pos + 1, std::memory_order_release);
+  }
+
+  void flight_recorder::store (slot& s, const record& entry, std::string_view message, std::string_view fields,
+                               std::uint32_t format_id) {
+    s.m_time.store(entry.time_point().time_since_epoch().count(), std::memory_order_relaxed);
+    s.m_level.store(entry.level(), std::memory_order_relaxed);
+    s.m_line.store(entry.line().n, std::memory_order_relaxed);
+    s.m_thread_id.store(entry.thread_id(), std::memory_order_relaxed);
+    s.m_os_thread_id.store(entry.os_thread_id(), std::memory_order_relaxed);
+    s.m_format_id.store(format_id, std::memory_order_relaxed);
+    s.m_message_size.store(static_cast<std::uint32_t>(message.size()), std::memory_order_relaxed);
+    s.m_fields_size.store(static_cast<std::uint32_t>(fields.size()), std::memory_order_relaxed);
+    if (!message.empty()) {
+      std::memcpy(s.m_text, message.data(), message.size());
+    }
+    if (!fields.empty()) {
+      std::memcpy(s.m_text + message.size(), fields.data(), fields.size());
+    }
+  }
+
+  void flight_recorder::dump (std::ostream& out) const {
+    const std::uint64_t head = m_head.load(std::memory_order_acquire);
+    const std::uint64_t count = std::min<std::uint64_t>(head, m_mask + 1);
+
+    std::vector<record> records;
+    records.reserve(static_cast<std::size_t>(count));
+    for (std::uint64_t pos = head - count; pos < head; ++pos) {
+      const slot& s = m_slots[pos & m_mask];
+      const std::uint64_t seq = s.m_sequence.load(std::memory_order_acquire);
+      if (seq != (2 * pos + 2)) {
+        continue;
+      }
+      // copy the raw fields first, a record is only built from a consistent copy.
+      char text[record::inline_size];
+      const std::chrono::system_clock::time_point tp{std::chrono::system_clock::duration(s.m_time.load(std::memory_order_relaxed))};
+      const level lvl = s.m_level.load(std::memory_order_relaxed);
+      const std::uint32_t line = s.m_line.load(std::memory_order_relaxed);
+      const std::uint32_t thread_id = s.m_thread_id.load(std::memory_order_relaxed);
+      const std::uint32_t os_thread_id = s.m_os_thread_id.load(std::memory_order_relaxed);
+      const std::uint32_t format_id = s.m_format_id.load(std::memory_order_relaxed);
+      const std::size_t message_size = s.m_message_size.load(std::memory_order_relaxed);
+      const std::size_t fields_size = s.m_fields_size.load(std::memory_order_relaxed);
+      std::memcpy(text, s.m_text, sizeof(text));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((s.m_sequence.load(std::memory_order_relaxed) != seq) ||
+          (message_size > record::inline_size) || (fields_size > record::inline_size - message_size)) {
+        continue;
+      }
+      records.emplace_back(tp, lvl, thread_id, os_thread_id, line_id(line),
+                           std::string_view(text, message_size),
+                           std::string_view(text + message_size, fields_size),
+                           format_id);
+    }
+
+    for (auto& entry : records) {
+      try {
+        m_formatter(out, entry);
+      } catch (const std::exception& ex) {
+        std::cerr << "flight_recorder::dump:" << ex.what();
+      }
+    }
+    out.flush();
+  }
+
+  void flight_recorder::dump () const {
+    std::lock_guard<std::mutex> lock(m_dump_mutex);
+    if (m_dump_file.empty()) {
+      dump(std::cerr);
+      return;
+    }
+    std::ofstream file(m_dump_file, std::ios_base::out | std::ios_base::app);
+    if (!file) {
+      std::cerr << "flight_recorder::dump: could not open " << m_dump_file << std::endl;
+      return;
+    }
+    dump(file);
+  }
+
+  std::size_t flight_recorder::size () const {
+    return static_cast<std::size_t>(std::min<std::uint64_t>(m_head.load(), m_mask + 1));
+  }
+
+  std::size_t flight_recorder::capacity () const {
+    return m_mask + 1;
+  }
+
+  const record_formatter& flight_recorder::formatter () const {
+    return m_formatter;
+  }
+
+} // namespace logging
@@ -0,0 +1,119 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "render_buffer.h"
+#include "formatter.h"
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * In-memory ring of the most recent raw records.
+    * Adding a record only copies it into the next slot, nothing is rendered
+    * until the ring is dumped. Records must fit inline, larger ones keep
+    * their formatted message truncated to record::inline_size and lose their fields.
+    * There is a single writer, the dispatching core, dumps may run in any
+    * thread concurrently. Each slot holds the raw fields of a record and is
+    * guarded by a sequence counter. A dump copies the raw bytes, skips slots
+    * that are overwritten meanwhile and validates the sizes, before it builds
+    * a record from them.
+    */
+  class LOGGING_EXPORT flight_recorder {
+  public:
+    /// ring for capacity records, rounded up to a power of 2, dumped to dump_file or std::cerr if empty.
+    flight_recorder (std::size_t capacity,
+                     const std::string& dump_file = std::string(),
+                     const record_formatter& formatter = standard_formatter);
+
+    /// copy the record into the next slot and overwrite the oldest one, if the ring is full.
+    void add (const record& entry);
+
+    /// render the recorded records from the oldest to the newest.
+    void dump (std::ostream& out) const;
+
+    /// append the recorded records to the dump file.
+    void dump () const;
+
+    /// number of recorded records, at most the capacity.
+    std::size_t size () const;
+
+    std::size_t capacity () const;
+
+    const record_formatter& formatter () const;
+
+    flight_recorder (const flight_recorder&) = delete;
+    void operator= (const flight_recorder&) = delete;
+
+  private:
+    struct slot {
+      /// odd while the record is written, 2 * (position + 1) when it is complete.
+      std::atomic<std::uint64_t> m_sequence{0};
+      std::atomic<std::chrono::system_clock::rep> m_time{0};
+      std::atomic<level> m_level{level::undefined};
+      std::atomic<std::uint32_t> m_line{0};
+      std::atomic<std::uint32_t> m_thread_id{0};
+      std::atomic<std::uint32_t> m_os_thread_id{0};
+      std::atomic<std::uint32_t> m_format_id{0};
+      std::atomic<std::uint32_t> m_message_size{0};
+      std::atomic<std::uint32_t> m_fields_size{0};
+      char m_text[record::inline_size];
+    };
+
+    /// write the fields and the text of a record into the slot, needs an odd sequence.
+    static void store (slot& s, const record& entry, std::string_view message, std::string_view fields,
+                       std::uint32_t format_id);
+
+    std::unique_ptr<slot[]> m_slots;
+    const std::size_t m_mask;
+    std::atomic<std::uint64_t> m_head;
+    std::string m_dump_file;
+    record_formatter m_formatter;
+
+    /// renders deferred or large messages, used by the writer only.
+    render_stream m_render;
+
+    /// serializes dumps to the file.
+    mutable std::mutex m_dump_mutex;
+  };
+
+} // namespace logging
@@ -0,0 +1,102 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "format_registry.h"
+
+
+namespace logging {
+
+  namespace {
+
+    /**
+      * Table of the interned formats. Formats are only added and live as long
+      * as the table, so readers can use them without a lock.
+      */
+    class format_table {
+    public:
+      format_table ()
+        : m_count(1)
+      {
+        for (auto& f : m_formats) {
+          f.store(nullptr, std::memory_order_relaxed);
+        }
+      }
+
+      std::uint32_t add (std::string_view format) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto i = m_ids.find(format);
+        if (i != m_ids.end()) {
+          return i->second;
+        }
+        const std::uint32_t count = m_count.load(std::memory_order_relaxed);
+        if (count == LOGGING_MAX_FORMATS) {
+          return 0;
+        }
+        m_storage.emplace_back(format);
+        m_formats[count].store(&m_storage.back(), std::memory_order_release);
+        m_ids.emplace(m_storage.back(), count);
+        m_count.store(count + 1, std::memory_order_release);
+        return count;
+      }
+
+      std::string_view get (std::uint32_t id) const {
+        if (id < LOGGING_MAX_FORMATS) {
+          const std::string* format = m_formats[id].load(std::memory_order_acquire);
+          if (format) {
+            return *format;
+          }
+        }
+        return std::string_view();
+      }
+
+      static format_table& instance () {
+        static format_table table;
+        return table;
+      }
+
+    private:
+      std::atomic<const std::string*> m_formats[LOGGING_MAX_FORMATS];
+      std::atomic<std::uint32_t> m_count;
+      std::deque<std::string> m_storage;
+      std::unordered_map<std::string_view, std::uint32_t> m_ids;
+      std::mutex m_mutex;
+    };
+
+  } // namespace
+
+  std::uint32_t format_registry::register_format (std::string_view format) {
+    return format_table::instance().add(format);
+  }
+
+  std::string_view format_registry::format (std::uint32_t id) {
+    return format_table::instance().get(id);
+  }
+
+} // namespace logging
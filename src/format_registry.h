@@ -0,0 +1,76 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "logging-export.h"
+
+#ifndef LOGGING_MAX_FORMATS
+# define LOGGING_MAX_FORMATS 4096
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Registry of the static format strings of deferred logging call sites.
+    *
+    * A format is registered once and gets an id, records only carry this id
+    * and the arguments. The format of an id is resolved without a lock.
+    * Id 0 means no format, it is also returned when the registry is full.
+    */
+  struct LOGGING_EXPORT format_registry {
+
+    /// Intern the format and return its id, the same format always gets the same id.
+    static std::uint32_t register_format (std::string_view format);
+
+    /// Format of the id, empty for 0 and unknown ids.
+    static std::string_view format (std::uint32_t id);
+
+  };
+
+  /**
+    * Static state of one deferred logging call site, holds the format id
+    * after the first call.
+    */
+  struct format_site {
+    std::uint32_t id (std::string_view format) {
+      std::uint32_t i = m_id.load(std::memory_order_relaxed);
+      if (i == 0) {
+        i = format_registry::register_format(format);
+        m_id.store(i, std::memory_order_relaxed);
+      }
+      return i;
+    }
+
+    std::atomic<std::uint32_t> m_id{0};
+  };
+
+} // namespace logging
@@ -27,6 +27,7 @@
 //
 #include "record.h"
 #include "recorder.h"
+#include "format_registry.h"
 #include "logging-export.h"
 
 
@@ -77,26 +78,59 @@ namespace logging {
       out << e.thread_name();
     }
 
+    inline void thread_id (std::ostream& out, const logging::record& e) {
+      out << e.os_thread_id();
+    }
+
+    /// message of the record, a deferred format is formatted with its arguments.
     inline void message (std::ostream& out, const logging::record& e) {
-      out << e.message();
+      if (e.format_id()) {
+        print_formatted(out, format_registry::format(e.format_id()), e.fields());
+      } else {
+        out << e.message();
+      }
+    }
+
+    /// structured fields as "key=value key=value", the arguments of a deferred format have no key.
+    inline void fields (std::ostream& out, const logging::record& e) {
+      print_fields(out, e.fields());
+    }
+
+    /// structured fields as json object, nan and infinity as null.
+    inline void fields_json (std::ostream& out, const logging::record& e) {
+      print_fields_json(out, e.fields());
+    }
+
+    /// message followed by the structured fields, if there are any.
+    inline void message_and_fields (std::ostream& out, const logging::record& e) {
+      message(out, e);
+      if (!e.format_id() && !e.fields().empty()) {
+        out << ' ';
+        print_fields(out, e.fields());
+      }
     }
 
     inline void endl (std::ostream& out, const logging::record&) {
-      out << std::endl;
+      out << '\n';
     }
 
   } // namespace fmt
 
   inline void standard_formatter (std::ostream& out, const record& e) {
-    out << e.line() << '|' << e.time_point() << '|' << e.level() << '|' << e.thread_name() << '|' << e.message() << std::endl;
+    out << e.line() << '|' << e.time_point() << '|' << e.level() << '|' << e.thread_name() << '|';
+    fmt::message_and_fields(out, e);
+    out << '\n';
   }
 
   inline void no_time_formatter (std::ostream& out, const record& e) {
-    out << e.level() << '|' << e.thread_name() << '|' << e.message() << std::endl;
+    out << e.level() << '|' << e.thread_name() << '|';
+    fmt::message_and_fields(out, e);
+    out << '\n';
   }
 
   inline void console_formatter (std::ostream& out, const record& e) {
-    out << e.message() << std::endl;
+    fmt::message_and_fields(out, e);
+    out << '\n';
   }
 
   inline record_formatter custom_formatter (const std::vector<record_formatter>& fmts) {
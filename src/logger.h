@@ -21,10 +21,32 @@
 // Library includes
 //
 #include "recorder.h"
+#include "core.h"
+#include "format_registry.h"
+
+/**
+* Compile time minimum level. Logging below this level is removed completely.
+* The values correspond to logging::level: 1 trace, 2 debug, 3 info, 4 warning, 5 error, 6 fatal.
+* Default is trace if LOGGING_ENABLE_TRACE is defined, info if NDEBUG is defined, else debug.
+*/
+#ifndef LOGGING_MIN_LEVEL
+# if defined(LOGGING_ENABLE_TRACE)
+#  define LOGGING_MIN_LEVEL 1
+# elif defined(NDEBUG)
+#  define LOGGING_MIN_LEVEL 3
+# else
+#  define LOGGING_MIN_LEVEL 2
+# endif
+#endif // LOGGING_MIN_LEVEL
 
 namespace logging {
 
-#if defined(LOGGING_ENABLE_TRACE)
+  /// return true if logging of level lvl is compiled in, see LOGGING_MIN_LEVEL.
+  constexpr bool is_compiled_level (level lvl) {
+    return (lvl == level::fatal) || (static_cast<int>(lvl) >= LOGGING_MIN_LEVEL);
+  }
+
+#if LOGGING_MIN_LEVEL <= 1
   struct trace : public recorder {
     inline trace ()
       : recorder(level::trace)
@@ -32,35 +54,47 @@ namespace logging {
   };
 #else
   struct trace : public  null_recoder {};
-#endif // LOGGING_ENABLE_TRACE
+#endif
 
-#if defined(NDEBUG)
-  struct debug : public  null_recoder {};
-#else
+#if LOGGING_MIN_LEVEL <= 2
   struct debug : public recorder {
     inline debug ()
       : recorder(level::debug)
     {}
   };
-#endif // NDEBUG
+#else
+  struct debug : public  null_recoder {};
+#endif
 
+#if LOGGING_MIN_LEVEL <= 3
   struct info : public recorder {
     inline info ()
       : recorder(level::info)
     {}
   };
+#else
+  struct info : public  null_recoder {};
+#endif
 
+#if LOGGING_MIN_LEVEL <= 4
   struct warn : public recorder {
     inline warn ()
       : recorder(level::warning)
     {}
   };
+#else
+  struct warn : public  null_recoder {};
+#endif
 
+#if LOGGING_MIN_LEVEL <= 5
   struct error : public recorder {
     inline error ()
       : recorder(level::error)
     {}
   };
+#else
+  struct error : public  null_recoder {};
+#endif
 
   struct fatal : public recorder {
     inline fatal ()
@@ -68,4 +102,72 @@ namespace logging {
     {}
   };
 
+  /**
+    * Log with a deferred format. Only the format id of the call site and the
+    * encoded arguments are stored in the record, the sink formats them or
+    * writes them in binary form. Arguments can be numbers, bools and strings.
+    */
+  template <typename... Args>
+  void log_deferred (level lvl, format_site& site, std::string_view format, const Args&... args) {
+    thread_local std::string buffer;
+    buffer.clear();
+    (encode_field(buffer, field(std::string_view(), args)), ...);
+    core::instance().log_deferred(lvl, site.id(format), buffer);
+  }
+
 } // namespace logging
+
+/**
+* Logging macros. The arguments are only evaluated, if the level is enabled at runtime.
+*
+* LOG_INFO("i = " << i << "!");
+*/
+#define LOGGING_LOG(LVL, ...) \
+  if (!logging::core::instance().is_enabled(LVL)) {} else logging::recorder(LVL) << __VA_ARGS__
+
+#if LOGGING_MIN_LEVEL <= 1
+# define LOG_TRACE(...) LOGGING_LOG(logging::level::trace, __VA_ARGS__)
+#else
+# define LOG_TRACE(...) ((void)0)
+#endif
+
+#if LOGGING_MIN_LEVEL <= 2
+# define LOG_DEBUG(...) LOGGING_LOG(logging::level::debug, __VA_ARGS__)
+#else
+# define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOGGING_MIN_LEVEL <= 3
+# define LOG_INFO(...) LOGGING_LOG(logging::level::info, __VA_ARGS__)
+#else
+# define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOGGING_MIN_LEVEL <= 4
+# define LOG_WARN(...) LOGGING_LOG(logging::level::warning, __VA_ARGS__)
+#else
+# define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOGGING_MIN_LEVEL <= 5
+# define LOG_ERROR(...) LOGGING_LOG(logging::level::error, __VA_ARGS__)
+#else
+# define LOG_ERROR(...) ((void)0)
+#endif
+
+#define LOG_FATAL(...) LOGGING_LOG(logging::level::fatal, __VA_ARGS__)
+
+/**
+* Deferred format macro. The format is registered once per call site, each "{}" is
+* replaced by the next argument, when the record is written.
+* Levels below LOGGING_MIN_LEVEL are removed at compile time, if LVL is a constant.
+*
+* LOG_FORMAT(logging::level::info, "i = {}, name = {}", i, name);
+*/
+#define LOG_FORMAT(LVL, ...) \
+  do { \
+    static logging::format_site logging_site; \
+    if (logging::is_compiled_level(LVL) && logging::core::instance().is_enabled(LVL)) { \
+      logging::log_deferred(LVL, logging_site, __VA_ARGS__); \
+    } \
+  } while (false)
@@ -14,6 +14,13 @@
 * @license   MIT license. See accompanying file LICENSE.
 */
 
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <iterator>
+#include <thread>
+
 // --------------------------------------------------------------------------
 //
 // Library includes
@@ -23,13 +30,84 @@
 
 namespace logging {
 
+  namespace {
+
+    /// Number of dequeued items, before the queue storage is compacted.
+    constexpr std::size_t compact_count = 1024;
+
+    /// Holds the item guard while the items are changed, for_each_pending keeps it only shortly.
+    class items_lock {
+    public:
+      explicit items_lock (std::atomic_flag& guard)
+        : m_guard(guard)
+      {
+        while (m_guard.test_and_set(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+      }
+
+      ~items_lock () {
+        m_guard.clear(std::memory_order_release);
+      }
+
+      items_lock (const items_lock&) = delete;
+      void operator= (const items_lock&) = delete;
+
+    private:
+      std::atomic_flag& m_guard;
+    };
+
+  } // namespace
+
   /// Enqueue an item and send signal to a waiting dequeuer.
   void message_queue::enqueue (record&& t) {
+    push(std::move(t), true);
+  }
+
+  /// Enqueue an item, waits for room instead of dropping it.
+  void message_queue::enqueue_waiting (record&& t) {
+    push(std::move(t), false);
+  }
+
+  void message_queue::push (record&& t, bool may_drop) {
+    bool waiting = false;
     {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_queue.push(std::move(t));
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_limits.is_limited() && is_full(t)) {
+        switch (may_drop ? m_limits.policy : overflow_policy::block) {
+          case overflow_policy::drop_below_level:
+            if (t.level() >= m_limits.drop_level) {
+              // important enough to wait for.
+              ++m_blocked;
+              m_space_condition.wait(lock, [&] () { return !is_full(t); });
+              --m_blocked;
+              break;
+            }
+            m_dropped.add(t.level());
+            return;
+          case overflow_policy::drop_newest:
+            m_dropped.add(t.level());
+            return;
+          case overflow_policy::drop_oldest:
+            while (!is_empty() && is_full(t)) {
+              drop_front();
+            }
+            break;
+          case overflow_policy::block:
+            ++m_blocked;
+            m_space_condition.wait(lock, [&] () { return !is_full(t); });
+            --m_blocked;
+            break;
+        }
+      }
+      m_bytes += t.byte_size();
+      items_lock changing(m_items_guard);
+      m_queue.emplace_back(std::move(t));
+      waiting = m_waiting.load(std::memory_order_relaxed);
+    }
+    if (waiting) {
+      m_condition.notify_one();
     }
-    m_condition.notify_all();
   }
 
   /// Dequeue an item if available, else waits until a new item is enqueued.
@@ -38,45 +116,170 @@ namespace logging {
 
     wait_until_not_empty(lock);
 
-    if (m_queue.empty()) {
-      return record();
-    }
-
-    record item = m_queue.front();
-    m_queue.pop();
-    m_condition.notify_all();
+    record item;
+    take_front(item);
     return item;
   }
 
   /// Dequeue an item if available and return true, else return false.
   bool message_queue::try_dequeue (record& t) {
-    std::unique_lock<std::mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return take_front(t);
+  }
 
-    if (m_queue.empty()) {
-      return false;
+  /// Move all available items to the end of items under one lock, returns the number of moved items.
+  std::size_t message_queue::drain (std::vector<record>& items) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    items_lock changing(m_items_guard);
+
+    const std::size_t count = m_queue.size() - m_front;
+    if (items.empty() && (m_front == 0)) {
+      // hand out the whole storage and take over the (empty) one of the caller.
+      items.swap(m_queue);
+    } else {
+      items.insert(items.end(),
+                   std::make_move_iterator(m_queue.begin() + m_front),
+                   std::make_move_iterator(m_queue.end()));
+      m_queue.clear();
     }
+    m_front = 0;
+    m_bytes = 0;
 
-    t = m_queue.front();
-    m_queue.pop();
-    m_condition.notify_all();
-    return true;
+    if (m_empty_waiters > 0) {
+      m_empty_condition.notify_all();
+    }
+    notify_space();
+    return count;
   }
 
   /// Waits until the queue is empty for maximum timeout time span.
   void message_queue::wait_until_empty (const std::chrono::milliseconds& timeout) {
     std::unique_lock<std::mutex> lock(m_mutex);
 
-    m_condition.wait_for(lock, timeout, [&]() {
-      return m_queue.empty();
+    ++m_empty_waiters;
+    m_empty_condition.wait_for(lock, timeout, [&]() {
+      return is_empty();
     });
+    --m_empty_waiters;
   }
 
   /// Waits until the queue is no more empty.
   void message_queue::wait_until_not_empty (std::unique_lock<std::mutex> &lock) {
+    m_waiting.store(true);
     m_condition.wait(lock, [&] () -> bool {
-                       return !m_queue.empty();
+                       return !is_empty();
                      });
+    m_waiting.store(false);
   }
 
-} // namespace logging
+  /// Return true if there is no item in the queue.
+  bool message_queue::empty () const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return is_empty();
+  }
+
+  /// Waits until an item is available, ready returns true or wake is called.
+  void message_queue::wait_for_items (const std::function<bool()>& ready,
+                                      std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waiting.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto is_ready = [&] () -> bool {
+      return !is_empty() || m_woken || (ready && ready());
+    };
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+      m_condition.wait(lock, is_ready);
+    } else {
+      m_condition.wait_until(lock, deadline, is_ready);
+    }
+    m_waiting.store(false);
+    m_woken = false;
+  }
+
+  /// Wake the dequeuer, if it is waiting in wait_for_items.
+  void message_queue::wake () {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed)) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_woken = true;
+      }
+      m_condition.notify_all();
+    }
+  }
 
+  bool message_queue::is_empty () const {
+    return m_front == m_queue.size();
+  }
+
+  bool message_queue::take_front (record& t) {
+    if (is_empty()) {
+      return false;
+    }
+    items_lock changing(m_items_guard);
+    m_bytes -= m_queue[m_front].byte_size();
+    t = std::move(m_queue[m_front]);
+    ++m_front;
+    notify_space();
+    if (is_empty()) {
+      m_queue.clear();
+      m_front = 0;
+      if (m_empty_waiters > 0) {
+        m_empty_condition.notify_all();
+      }
+    } else if ((m_front >= compact_count) && (m_front * 2 >= m_queue.size())) {
+      m_queue.erase(m_queue.begin(), m_queue.begin() + m_front);
+      m_front = 0;
+    }
+    return true;
+  }
+
+  /// Set the capacity limits and the overflow policy.
+  void message_queue::set_limits (const queue_limits& limits) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limits = limits;
+    // maybe the limits are wider now.
+    notify_space();
+  }
+
+  /// Get the capacity limits and the overflow policy.
+  queue_limits message_queue::get_limits () const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_limits;
+  }
+
+  /// Counters of the records dropped due to the limits.
+  const drop_counter& message_queue::dropped () const {
+    return m_dropped;
+  }
+
+  bool message_queue::is_full (const record& t) const {
+    if (!m_limits.is_limited() || is_empty()) {
+      // always accept one item, even if it is bigger than max_bytes.
+      return false;
+    }
+    const std::size_t count = m_queue.size() - m_front;
+    return ((m_limits.max_records > 0) && (count >= m_limits.max_records)) ||
+           ((m_limits.max_bytes > 0) && (m_bytes + t.byte_size() > m_limits.max_bytes));
+  }
+
+  void message_queue::drop_front () {
+    items_lock changing(m_items_guard);
+    const record& t = m_queue[m_front];
+    m_dropped.add(t.level());
+    m_bytes -= t.byte_size();
+    m_queue[m_front] = record();
+    ++m_front;
+    if (is_empty()) {
+      m_queue.clear();
+      m_front = 0;
+    }
+  }
+
+  void message_queue::notify_space () {
+    if (m_blocked > 0) {
+      m_space_condition.notify_all();
+    }
+  }
+
+} // namespace logging
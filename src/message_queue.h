@@ -20,9 +20,11 @@
 //
 // Common includes
 //
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
-#include <queue>
+#include <vector>
 #if defined USE_MINGW && __MINGW_GCC_VERSION < 100000
 #include <mingw/mingw.condition_variable.h>
 #include <mingw/mingw.mutex.h>
@@ -33,6 +35,7 @@
 // Library includes
 //
 #include "record.h"
+#include "queue_limits.h"
 
 
 #ifdef WIN32
@@ -46,34 +49,123 @@ namespace logging {
 
   /**
     * Blocking (waiting) thread safe fifo queue.
+    * Optional limited in number of items and bytes.
     */
   struct LOGGING_EXPORT message_queue {
 
-    /// Enqueue an item and send signal to a waiting dequeuer.
+    /// Enqueue an item and send signal to a waiting dequeuer, respects the limits and their overflow policy.
     void enqueue (record&& t);
 
+    /// Enqueue an item like enqueue, but waits for room instead of dropping it, if the queue is full.
+    void enqueue_waiting (record&& t);
+
     /// Dequeue an item if available, else waits until a new item is enqueued.
     record dequeue ();
 
     /// Dequeue an item if available and return true, else return false.
     bool try_dequeue (record& t);
 
+    /// Move all available items to the end of items under one lock, returns the number of moved items.
+    std::size_t drain (std::vector<record>& items);
+
     /// Waits until the queue is empty for maximum timeout time span.
     void wait_until_empty (const std::chrono::milliseconds& timeout);
 
     /// Waits until the queue is no more empty.
     void wait_until_not_empty (std::unique_lock<std::mutex> &lock);
 
+    /// Return true if there is no item in the queue.
+    bool empty () const;
+
+    /**
+      * Call f for each item without dequeuing it, if no other thread changes the items.
+      * Never waits and takes no mutex, so it can be called from a signal handler.
+      * Returns false, if the items are changed right now.
+      */
+    template<typename F>
+    bool for_each_pending (F f) const {
+      if (m_items_guard.test_and_set(std::memory_order_acquire)) {
+        return false;
+      }
+      for (std::size_t i = m_front; i < m_queue.size(); ++i) {
+        f(m_queue[i]);
+      }
+      m_items_guard.clear(std::memory_order_release);
+      return true;
+    }
+
+    /// Waits until an item is available, ready returns true, wake is called or the deadline is reached.
+    void wait_for_items (const std::function<bool()>& ready,
+                         std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    /// Wake the dequeuer, if it is waiting in wait_for_items.
+    void wake ();
+
+    /// Set the capacity limits and the overflow policy.
+    void set_limits (const queue_limits& limits);
+
+    /// Get the capacity limits and the overflow policy.
+    queue_limits get_limits () const;
+
+    /// Counters of the records dropped due to the limits.
+    const drop_counter& dropped () const;
+
   private:
-    /// The queue to store the items in.
-    std::queue<record> m_queue;
+    /// Enqueue an item, may_drop false waits for room whatever the overflow policy is.
+    void push (record&& t, bool may_drop);
+
+    /// Return true if t does not fit into the limits, needs the lock.
+    bool is_full (const record& t) const;
+
+    /// Drop the front item, needs the lock.
+    void drop_front ();
+
+    /// Signal waiting enqueuers, that there is room again, needs the lock.
+    void notify_space ();
+
+    /// Return true if there is no item left in the queue, needs the lock.
+    bool is_empty () const;
+
+    /// Move the front item to t if available and return true, needs the lock.
+    bool take_front (record& t);
+
+    /// The items, the next one to dequeue is at m_front.
+    std::vector<record> m_queue;
+    std::size_t m_front = 0;
+
+    /// Taken in addition to the mutex while the items are changed and by for_each_pending.
+    mutable std::atomic_flag m_items_guard = ATOMIC_FLAG_INIT;
 
     /// Condition to signal new item to dequeuer.
     std::condition_variable m_condition;
 
+    /// Condition to signal an empty queue.
+    std::condition_variable m_empty_condition;
+
+    /// Number of threads waiting in wait_until_empty.
+    unsigned int m_empty_waiters = 0;
+
     /// Mutex for thread safe access to the queue.
     mutable std::mutex m_mutex;
 
+    /// True while the dequeuer waits for new items.
+    std::atomic_bool m_waiting{false};
+
+    /// Set by wake to release the waiting dequeuer.
+    bool m_woken = false;
+
+    /// Capacity limits, overflow policy and the bytes of the queued items.
+    queue_limits m_limits;
+    std::size_t m_bytes = 0;
+
+    /// Condition to signal room to blocked enqueuers.
+    std::condition_variable m_space_condition;
+
+    /// Number of enqueuers waiting for room.
+    unsigned int m_blocked = 0;
+
+    drop_counter m_dropped;
+
   };
 
 } // namespace logging
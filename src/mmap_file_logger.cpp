@@ -0,0 +1,168 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "mmap_file_logger.h"
+
+
+namespace logging {
+
+  mmap_file_buffer::mmap_file_buffer ()
+    : m_fd(-1)
+    , m_segment(nullptr)
+    , m_offset(0)
+  {}
+
+  mmap_file_buffer::~mmap_file_buffer () {
+    close();
+  }
+
+  bool mmap_file_buffer::open (const std::string& name, const mmap_file_options& options) {
+    close();
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    m_options = options;
+    m_options.segment_size = std::max(page, (options.segment_size + page - 1) / page * page);
+
+    m_fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+      return false;
+    }
+    m_offset = 0;
+    if (!next_segment()) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void mmap_file_buffer::close () {
+    if (m_fd < 0) {
+      return;
+    }
+    const std::size_t size = written();
+    unmap();
+    if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+      // keep the preallocated rest, the file is still readable up to the zeros.
+    }
+    ::close(m_fd);
+    m_fd = -1;
+    m_offset = 0;
+  }
+
+  bool mmap_file_buffer::is_open () const {
+    return m_fd >= 0;
+  }
+
+  std::size_t mmap_file_buffer::written () const {
+    return m_segment ? m_offset + static_cast<std::size_t>(pptr() - pbase()) : m_offset;
+  }
+
+  bool mmap_file_buffer::sync_to_storage () {
+    if (m_fd < 0) {
+      return false;
+    }
+    if (m_segment && (msync(m_segment, static_cast<std::size_t>(pptr() - pbase()), MS_SYNC) != 0)) {
+      return false;
+    }
+    return sync_file(m_fd);
+  }
+
+  mmap_file_buffer::int_type mmap_file_buffer::overflow (int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    if ((pptr() == epptr()) && !next_segment()) {
+      return traits_type::eof();
+    }
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+  }
+
+  std::streamsize mmap_file_buffer::xsputn (const char* s, std::streamsize n) {
+    std::streamsize done = 0;
+    while (done < n) {
+      if ((pptr() == epptr()) && !next_segment()) {
+        break;
+      }
+      const std::streamsize count = std::min(n - done, static_cast<std::streamsize>(epptr() - pptr()));
+      std::memcpy(pptr(), s + done, static_cast<std::size_t>(count));
+      pbump(static_cast<int>(count));
+      done += count;
+    }
+    return done;
+  }
+
+  int mmap_file_buffer::sync () {
+    if (m_options.msync_on_flush && m_segment) {
+      return msync(m_segment, static_cast<std::size_t>(pptr() - pbase()), MS_SYNC);
+    }
+    return 0;
+  }
+
+  bool mmap_file_buffer::next_segment () {
+    if (m_segment) {
+      m_offset += m_options.segment_size;
+      unmap();
+    }
+#ifdef __linux__
+    if (posix_fallocate(m_fd, static_cast<off_t>(m_offset), static_cast<off_t>(m_options.segment_size)) != 0) {
+      return false;
+    }
+#else
+    if (ftruncate(m_fd, static_cast<off_t>(m_offset + m_options.segment_size)) != 0) {
+      return false;
+    }
+#endif
+    void* segment = mmap(nullptr, m_options.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         m_fd, static_cast<off_t>(m_offset));
+    if (segment == MAP_FAILED) {
+      return false;
+    }
+    m_segment = static_cast<char*>(segment);
+    setp(m_segment, m_segment + m_options.segment_size);
+    return true;
+  }
+
+  void mmap_file_buffer::unmap () {
+    if (m_segment) {
+      // start the write back of the full segment, but do not wait for it.
+      msync(m_segment, m_options.segment_size, MS_ASYNC);
+      munmap(m_segment, m_options.segment_size);
+      m_segment = nullptr;
+      setp(nullptr, nullptr);
+    }
+  }
+
+} // namespace logging
+
+#endif // WIN32
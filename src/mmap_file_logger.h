@@ -0,0 +1,125 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Options of a memory mapped log file.
+    */
+  struct mmap_file_options {
+    /// Size of one preallocated and mapped segment, rounded up to whole pages.
+    std::size_t segment_size = 16 * 1024 * 1024;
+
+    /// msync the mapping on each flush of the sink, else flushes do nothing.
+    bool msync_on_flush = false;
+  };
+
+  /**
+    * Stream buffer that writes directly into a memory mapped file.
+    * The file grows by preallocated segments, only the current segment is mapped.
+    * When closed, the file is truncated to the written size.
+    */
+  class LOGGING_EXPORT mmap_file_buffer : public std::streambuf, public durable_buffer {
+  public:
+    mmap_file_buffer ();
+    ~mmap_file_buffer ();
+
+    /// open or create the file and map the first segment, returns false on error.
+    bool open (const std::string& name, const mmap_file_options& options = mmap_file_options());
+
+    /// unmap the segment and truncate the file to the written size.
+    void close ();
+
+    bool is_open () const;
+
+    /// bytes written since the file was opened.
+    std::size_t written () const;
+
+    /// msync the current segment and sync the file.
+    bool sync_to_storage () override;
+
+    mmap_file_buffer (const mmap_file_buffer&) = delete;
+    void operator= (const mmap_file_buffer&) = delete;
+
+  protected:
+    int_type overflow (int_type c) override;
+    std::streamsize xsputn (const char* s, std::streamsize n) override;
+    int sync () override;
+
+  private:
+    /// unmap the current segment and map the next one.
+    bool next_segment ();
+
+    void unmap ();
+
+    int m_fd;
+    mmap_file_options m_options;
+    char* m_segment;
+    std::size_t m_offset;
+  };
+
+  /**
+    * log to a memory mapped file. The sink thread copies the records
+    * straight into the mapping, without a syscall per write or flush.
+    * Automatic adds and remove itself to the logging core.
+    */
+  class mmap_file_logger {
+  public:
+    mmap_file_logger (const std::string& name, level lvl, const record_formatter& fmt,
+                      const mmap_file_options& options = mmap_file_options(),
+                      const flush_policy& flush = flush_policy())
+      : stream(&buffer)
+    {
+      if (buffer.open(name, options)) {
+        core::instance().add_sink(&stream, lvl, fmt, flush);
+      }
+    }
+
+    ~mmap_file_logger () {
+      core::instance().remove_sink(&stream);
+      buffer.close();
+    }
+
+  private:
+    mmap_file_buffer buffer;
+    std::ostream stream;
+  };
+
+} // namespace logging
+
+#endif // WIN32
@@ -0,0 +1,106 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "log_level.h"
+
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * What to do with a new record, when the queue is full.
+    */
+  enum class overflow_policy {
+    /// wait until the sink thread made room.
+    block,
+    /// drop the new record.
+    drop_newest,
+    /// drop the oldest records in the queue to make room for the new one.
+    drop_oldest,
+    /// drop the new record if its level is below drop_level, else wait.
+    drop_below_level
+  };
+
+  /**
+    * Capacity limits of the queue between the logging threads and the sink thread.
+    * A limit of 0 means unlimited.
+    */
+  struct queue_limits {
+    std::size_t max_records = 0;
+    std::size_t max_bytes = 0;
+    overflow_policy policy = overflow_policy::block;
+    level drop_level = level::warning;
+
+    bool is_limited () const {
+      return (max_records > 0) || (max_bytes > 0);
+    }
+  };
+
+  /**
+    * Thread safe counters of dropped records per level.
+    */
+  class drop_counter {
+  public:
+    static constexpr std::size_t level_count = static_cast<std::size_t>(level::fatal) + 1;
+
+    typedef std::array<std::size_t, level_count> counts;
+
+    drop_counter () {
+      for (auto& c : m_counts) {
+        c.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    /// count a dropped record of level lvl.
+    void add (level lvl) {
+      m_counts[static_cast<std::size_t>(lvl)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// number of dropped records of level lvl.
+    std::size_t get (level lvl) const {
+      return m_counts[static_cast<std::size_t>(lvl)].load(std::memory_order_relaxed);
+    }
+
+    /// number of dropped records of all levels.
+    counts get_all () const {
+      counts c;
+      for (std::size_t i = 0; i < level_count; ++i) {
+        c[i] = m_counts[i].load(std::memory_order_relaxed);
+      }
+      return c;
+    }
+
+  private:
+    std::array<std::atomic<std::size_t>, level_count> m_counts;
+  };
+
+} // namespace logging
@@ -18,9 +18,13 @@
 //
 // Common includes
 //
+#include <cstring>
 #include <iomanip>
+#include <limits>
+#include <mutex>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 
 // --------------------------------------------------------------------------
@@ -33,8 +37,6 @@
 
 namespace logging {
 
-  extern thread_local const char* t_thread_name;
-
   std::ostream& operator << (std::ostream& out, line_id const& id) {
     const auto fill = out.fill();
     const auto width = out.width();
@@ -44,23 +46,238 @@ namespace logging {
     return out;
   }
 
+  static_assert(sizeof(record) == LOGGING_RECORD_SIZE, "record must fill LOGGING_RECORD_SIZE");
+  static_assert(LOGGING_RECORD_SIZE % cache_line_size == 0, "LOGGING_RECORD_SIZE must be a multiple of the cache line size");
+
+  namespace {
+
+    /**
+      * Pool of overflow blocks for long texts, in size classes of powers of two.
+      * Blocks are taken by the logging threads and given back by the sink thread.
+      */
+    class overflow_pool {
+    public:
+      static constexpr std::size_t min_block = 512;
+      static constexpr std::size_t class_count = 8;
+      static constexpr std::size_t max_free = 64;
+
+      ~overflow_pool () {
+        for (auto& c : m_classes) {
+          for (char* b : c.m_free) {
+            delete [] b;
+          }
+        }
+      }
+
+      char* allocate (std::size_t size) {
+        const std::size_t i = class_of(size);
+        if (i < class_count) {
+          size_class& c = m_classes[i];
+          std::lock_guard<std::mutex> lock(c.m_mutex);
+          if (!c.m_free.empty()) {
+            char* b = c.m_free.back();
+            c.m_free.pop_back();
+            return b;
+          }
+          return new char[min_block << i];
+        }
+        return new char[size];
+      }
+
+      void release (char* block, std::size_t size) {
+        const std::size_t i = class_of(size);
+        if (i < class_count) {
+          size_class& c = m_classes[i];
+          std::lock_guard<std::mutex> lock(c.m_mutex);
+          if (c.m_free.size() < max_free) {
+            c.m_free.push_back(block);
+            return;
+          }
+        }
+        delete [] block;
+      }
+
+      static overflow_pool& instance () {
+        static overflow_pool pool;
+        return pool;
+      }
+
+    private:
+      static std::size_t class_of (std::size_t size) {
+        std::size_t i = 0;
+        while ((i < class_count) && ((min_block << i) < size)) {
+          ++i;
+        }
+        return i;
+      }
+
+      struct size_class {
+        std::mutex m_mutex;
+        std::vector<char*> m_free;
+      };
+
+      size_class m_classes[class_count];
+    };
+
+  } // namespace
+
+  record::record (const std::chrono::system_clock::time_point& time_point,
+                  logging::level lvl,
+                  line_id&& line,
+                  std::string_view message,
+                  std::string_view fields,
+                  std::uint32_t format_id)
+    : record(time_point, lvl, thread_registry::current_id(), thread_registry::current_os_id(),
+             std::move(line), message, fields, format_id)
+  {}
+
   record::record (const std::chrono::system_clock::time_point& time_point,
                   logging::level lvl,
-                  std::string thread_name,
+                  std::uint32_t thread_id,
+                  std::uint32_t os_thread_id,
                   line_id&& line,
-                  std::string&& message)
+                  std::string_view message,
+                  std::string_view fields,
+                  std::uint32_t format_id)
     : m_time_point(time_point)
-    , m_level(lvl)
-    , m_thread_name(std::move(thread_name))
+    , m_overflow(nullptr)
     , m_line(line)
-    , m_message(std::move(message))
-  {}
+    , m_level(lvl)
+    , m_message_size(0)
+    , m_fields_size(0)
+    , m_thread_id(thread_id)
+    , m_os_thread_id(os_thread_id)
+    , m_format_id(format_id)
+  {
+    assign(message, fields);
+  }
 
   record::record ()
     : m_time_point(std::chrono::system_clock::time_point())
+    , m_overflow(nullptr)
     , m_level(logging::level::undefined)
-    , m_thread_name(t_thread_name)
+    , m_message_size(0)
+    , m_fields_size(0)
+    , m_thread_id(thread_registry::current_id())
+    , m_os_thread_id(0)
+    , m_format_id(0)
   {}
 
+  record::~record () {
+    release();
+  }
+
+  record::record (const record& rhs)
+    : m_time_point(rhs.m_time_point)
+    , m_overflow(nullptr)
+    , m_line(rhs.m_line)
+    , m_level(rhs.m_level)
+    , m_message_size(0)
+    , m_fields_size(0)
+    , m_thread_id(rhs.m_thread_id)
+    , m_os_thread_id(rhs.m_os_thread_id)
+    , m_format_id(rhs.m_format_id)
+  {
+    copy_text(rhs);
+  }
+
+  record::record (record&& rhs) noexcept
+    : m_time_point(rhs.m_time_point)
+    , m_overflow(nullptr)
+    , m_line(rhs.m_line)
+    , m_level(rhs.m_level)
+    , m_message_size(0)
+    , m_fields_size(0)
+    , m_thread_id(rhs.m_thread_id)
+    , m_os_thread_id(rhs.m_os_thread_id)
+    , m_format_id(rhs.m_format_id)
+  {
+    move_text(rhs);
+  }
+
+  record& record::operator= (const record& rhs) {
+    if (this != &rhs) {
+      release();
+      m_time_point = rhs.m_time_point;
+      m_line = rhs.m_line;
+      m_level = rhs.m_level;
+      m_thread_id = rhs.m_thread_id;
+      m_os_thread_id = rhs.m_os_thread_id;
+      m_format_id = rhs.m_format_id;
+      copy_text(rhs);
+    }
+    return *this;
+  }
+
+  record& record::operator= (record&& rhs) noexcept {
+    if (this != &rhs) {
+      release();
+      m_time_point = rhs.m_time_point;
+      m_line = rhs.m_line;
+      m_level = rhs.m_level;
+      m_thread_id = rhs.m_thread_id;
+      m_os_thread_id = rhs.m_os_thread_id;
+      m_format_id = rhs.m_format_id;
+      move_text(rhs);
+    }
+    return *this;
+  }
+
+  void record::assign (std::string_view message, std::string_view fields) {
+    const std::size_t max_size = std::numeric_limits<std::uint32_t>::max() / 2;
+    message = message.substr(0, max_size);
+    if (fields.size() > max_size) {
+      // a cut field list can not be decoded.
+      fields = std::string_view();
+    }
+    m_message_size = static_cast<std::uint32_t>(message.size());
+    m_fields_size = static_cast<std::uint32_t>(fields.size());
+    char* buffer = m_inline;
+    if (text_size() > inline_size) {
+      m_overflow = overflow_pool::instance().allocate(text_size());
+      buffer = m_overflow;
+    }
+    // an empty view may have no data, memcpy needs valid pointers even for 0 bytes.
+    if (!message.empty()) {
+      std::memcpy(buffer, message.data(), message.size());
+    }
+    if (!fields.empty()) {
+      std::memcpy(buffer + message.size(), fields.data(), fields.size());
+    }
+  }
+
+  void record::copy_text (const record& rhs) {
+    m_message_size = rhs.m_message_size;
+    m_fields_size = rhs.m_fields_size;
+    char* buffer = m_inline;
+    if (rhs.m_overflow) {
+      m_overflow = overflow_pool::instance().allocate(text_size());
+      buffer = m_overflow;
+    }
+    std::memcpy(buffer, rhs.text(), text_size());
+  }
+
+  void record::move_text (record& rhs) {
+    m_message_size = rhs.m_message_size;
+    m_fields_size = rhs.m_fields_size;
+    if (rhs.m_overflow) {
+      m_overflow = rhs.m_overflow;
+      rhs.m_overflow = nullptr;
+    } else {
+      std::memcpy(m_inline, rhs.m_inline, text_size());
+    }
+    rhs.m_message_size = 0;
+    rhs.m_fields_size = 0;
+  }
+
+  void record::release () {
+    if (m_overflow) {
+      overflow_pool::instance().release(m_overflow, text_size());
+      m_overflow = nullptr;
+    }
+    m_message_size = 0;
+    m_fields_size = 0;
+  }
+
 } // namespace logging
 
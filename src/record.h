@@ -21,23 +21,33 @@
 // Common includes
 //
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 // --------------------------------------------------------------------------
 //
 // Library includes
 //
 #include "log_level.h"
+#include "thread_registry.h"
 
 #ifdef WIN32
 #pragma warning (disable: 4251)
 #endif
 
+#ifndef LOGGING_RECORD_SIZE
+# define LOGGING_RECORD_SIZE 256
+#endif
+
 /**
 * Provides an API for stream logging to multiple sinks.
 */
 namespace logging {
 
+  /// Assumed size of a cache line, used to keep producer and consumer data apart.
+  constexpr std::size_t cache_line_size = 64;
+
   /**
     * Id for current logged line.
     */
@@ -53,16 +63,42 @@ namespace logging {
 
   /**
     * Logging record. Holds data for one record.
+    *
+    * The record has a fixed size of whole cache lines (LOGGING_RECORD_SIZE).
+    * The message and the encoded structured fields are stored inline, if they
+    * fit, else in an overflow block taken from a shared pool. The thread is stored as id of the thread
+    * registry and as id of the operating system.
+    * A record with a deferred format carries the format id and the encoded
+    * arguments as fields instead of a message.
     */
   class LOGGING_EXPORT record {
   public:
+    /// record of the current thread.
+    record (const std::chrono::system_clock::time_point& time_point,
+            level lvl,
+            line_id&& line,
+            std::string_view message,
+            std::string_view fields = std::string_view(),
+            std::uint32_t format_id = 0);
+
+    /// record of a given thread.
     record (const std::chrono::system_clock::time_point& time_point,
             level lvl,
-            std::string thread_name,
+            std::uint32_t thread_id,
+            std::uint32_t os_thread_id,
             line_id&& line,
-            std::string&& message);
+            std::string_view message,
+            std::string_view fields = std::string_view(),
+            std::uint32_t format_id = 0);
 
     record ();
+    ~record ();
+
+    record (const record&);
+    record (record&&) noexcept;
+
+    record& operator= (const record&);
+    record& operator= (record&&) noexcept;
 
     /// Id of this logging entry
     const line_id& line () const;
@@ -74,17 +110,59 @@ namespace logging {
     const logging::level& level () const;
 
     /// name of the thread where this entry was created
-    const std::string& thread_name () const;
+    std::string_view thread_name () const;
+
+    /// id of the thread name in the thread registry
+    std::uint32_t thread_id () const;
+
+    /// id of the thread in the operating system
+    std::uint32_t os_thread_id () const;
 
     /// mesage of this entry
-    const std::string& message () const;
+    std::string_view message () const;
+
+    /// encoded structured fields of this entry, see for_each_field
+    std::string_view fields () const;
+
+    /// id of the deferred format in the format registry, 0 if the message is already formatted.
+    std::uint32_t format_id () const;
+
+    /// approximated memory used by this entry
+    std::size_t byte_size () const;
+
+    /// size of the header fields, the rest of the record holds the inline text.
+    static constexpr std::size_t header_size = 44;
+
+    /// maximal size of message and fields stored inline.
+    static constexpr std::size_t inline_size = LOGGING_RECORD_SIZE - header_size;
 
   private:
-    std::chrono::system_clock::time_point m_time_point;
-    logging::level m_level;
-    std::string m_thread_name;
+    /// store message and fields inline or in an overflow block.
+    void assign (std::string_view message, std::string_view fields);
+
+    /// copy the text of other, needs an empty record.
+    void copy_text (const record& other);
+
+    /// move the text of other and leave it empty, needs an empty record.
+    void move_text (record& other);
+
+    /// give the overflow block back and leave the record empty.
+    void release ();
+
+    const char* text () const;
+
+    std::size_t text_size () const;
+
+    alignas(cache_line_size) std::chrono::system_clock::time_point m_time_point;
+    char* m_overflow;
     line_id m_line;
-    std::string m_message;
+    logging::level m_level;
+    std::uint32_t m_message_size;
+    std::uint32_t m_fields_size;
+    std::uint32_t m_thread_id;
+    std::uint32_t m_os_thread_id;
+    std::uint32_t m_format_id;
+    char m_inline[inline_size];
 
   };
 
@@ -38,12 +38,40 @@ namespace logging {
     return m_level;
   }
 
-  inline const std::string& record::thread_name () const {
-    return m_thread_name;
+  inline std::string_view record::thread_name () const {
+    return thread_registry::name(m_thread_id);
   }
 
-  inline const std::string& record::message () const {
-    return m_message;
+  inline std::uint32_t record::thread_id () const {
+    return m_thread_id;
+  }
+
+  inline std::uint32_t record::os_thread_id () const {
+    return m_os_thread_id;
+  }
+
+  inline std::string_view record::message () const {
+    return std::string_view(text(), m_message_size);
+  }
+
+  inline std::string_view record::fields () const {
+    return std::string_view(text() + m_message_size, m_fields_size);
+  }
+
+  inline std::uint32_t record::format_id () const {
+    return m_format_id;
+  }
+
+  inline std::size_t record::byte_size () const {
+    return sizeof(record) + (m_overflow ? text_size() : 0);
+  }
+
+  inline const char* record::text () const {
+    return m_overflow ? m_overflow : m_inline;
+  }
+
+  inline std::size_t record::text_size () const {
+    return std::size_t(m_message_size) + m_fields_size;
   }
 
 } // namespace logging
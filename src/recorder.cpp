@@ -18,7 +18,11 @@
 //
 // Common includes
 //
-#include <iomanip>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <vector>
 
 // --------------------------------------------------------------------------
 //
@@ -42,60 +46,72 @@ namespace logging {
     return t;
   }
 
-  void print_date (std::ostream& out, std::chrono::system_clock::time_point const& tp) {
-    std::time_t now = std::chrono::system_clock::to_time_t(tp);
-    std::tm t = time_t2tm(now);
+  namespace {
 
-    const auto fill = out.fill();
-    const auto width = out.width();
+    /// write value with count digits, filled with leading zeros.
+    inline void write_digits (char* p, unsigned int value, int count) {
+      for (int i = count - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+      }
+    }
 
-    out << std::setfill('0')
-        << (t.tm_year + 1900) << '-'
-        << std::setw(2) << (t.tm_mon + 1) << '-'
-        << std::setw(2) << t.tm_mday;
+    /**
+      * Rendered local date and time "YYYY-MM-DD HH:MM:SS" of one second.
+      * Only when the second changes, localtime is called and the text is rendered again.
+      */
+    struct time_cache {
+      static constexpr std::size_t date_size = 10;
+      static constexpr std::size_t time_offset = 11;
+      static constexpr std::size_t time_size = 8;
+      static constexpr std::size_t size = 19;
+
+      const char* get (std::chrono::system_clock::time_point const& tp) {
+        const auto seconds = std::chrono::floor<std::chrono::seconds>(tp).time_since_epoch().count();
+        if (!m_valid || (seconds != m_seconds)) {
+          std::tm t = time_t2tm(static_cast<std::time_t>(seconds));
+          write_digits(m_text, static_cast<unsigned int>(t.tm_year + 1900), 4);
+          m_text[4] = '-';
+          write_digits(m_text + 5, static_cast<unsigned int>(t.tm_mon + 1), 2);
+          m_text[7] = '-';
+          write_digits(m_text + 8, static_cast<unsigned int>(t.tm_mday), 2);
+          m_text[10] = ' ';
+          write_digits(m_text + 11, static_cast<unsigned int>(t.tm_hour), 2);
+          m_text[13] = ':';
+          write_digits(m_text + 14, static_cast<unsigned int>(t.tm_min), 2);
+          m_text[16] = ':';
+          write_digits(m_text + 17, static_cast<unsigned int>(t.tm_sec), 2);
+          m_seconds = seconds;
+          m_valid = true;
+        }
+        return m_text;
+      }
 
-    out.fill(fill);
-    out.width(width);
-  }
+      bool m_valid = false;
+      std::chrono::seconds::rep m_seconds = 0;
+      char m_text[size];
+    };
 
-  void print_time (std::ostream& out, std::chrono::system_clock::time_point const& tp) {
-    std::time_t now = std::chrono::system_clock::to_time_t(tp);
-    std::tm t = time_t2tm(now);
+    thread_local time_cache t_time_cache;
 
-    const auto fill = out.fill();
-    const auto width = out.width();
+  } // namespace
 
-    out << std::setfill('0')
-        << std::setw(2) << t.tm_hour << ':'
-        << std::setw(2) << t.tm_min << ':'
-        << std::setw(2) << t.tm_sec;
+  void print_date (std::ostream& out, std::chrono::system_clock::time_point const& tp) {
+    out.write(t_time_cache.get(tp), time_cache::date_size);
+  }
 
-    out.fill(fill);
-    out.width(width);
+  void print_time (std::ostream& out, std::chrono::system_clock::time_point const& tp) {
+    out.write(t_time_cache.get(tp) + time_cache::time_offset, time_cache::time_size);
   }
 
   std::ostream& operator << (std::ostream& out, std::chrono::system_clock::time_point const& tp) {
-    std::time_t now = std::chrono::system_clock::to_time_t(tp);
-    std::tm t = time_t2tm(now);
-
-    const auto fill = out.fill();
-    const auto width = out.width();
-
-    out << std::setfill('0')
-        << (t.tm_year + 1900) << '-'
-        << std::setw(2) << (t.tm_mon + 1) << '-'
-        << std::setw(2) << t.tm_mday << ' '
-        << std::setw(2) << t.tm_hour << ':'
-        << std::setw(2) << t.tm_min << ':'
-        << std::setw(2) << t.tm_sec;
-
-    auto t0 = std::chrono::time_point_cast<std::chrono::seconds>(tp);
-    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(tp - t0);
-    out << '.' << std::setfill('0') << std::setw(6) << micros.count();
-
-    out.fill(fill);
-    out.width(width);
-
+    char buffer[time_cache::size + 7];
+    std::memcpy(buffer, t_time_cache.get(tp), time_cache::size);
+    const auto t0 = std::chrono::floor<std::chrono::seconds>(tp);
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(tp - t0);
+    buffer[time_cache::size] = '.';
+    write_digits(buffer + time_cache::size + 1, static_cast<unsigned int>(micros.count()), 6);
+    out.write(buffer, sizeof(buffer));
     return out;
   }
 
@@ -123,46 +139,201 @@ namespace logging {
     }
   }
 
+  namespace {
+
+    /// Maximum number of free buffers kept per thread.
+    constexpr std::size_t max_pooled_buffers = 4;
+
+    /**
+      * Free recorder buffers of the current thread.
+      * A stack, since recorders can nest, e.g. when an operator<< logs itself.
+      */
+    struct buffer_pool {
+      std::unique_ptr<render_stream> acquire () {
+        if (m_free.empty()) {
+          return std::unique_ptr<render_stream>(new render_stream());
+        }
+        std::unique_ptr<render_stream> buffer = std::move(m_free.back());
+        m_free.pop_back();
+        buffer->reset();
+        return buffer;
+      }
+
+      void release (std::unique_ptr<render_stream>&& buffer) {
+        if (m_free.size() < max_pooled_buffers) {
+          m_free.emplace_back(std::move(buffer));
+        }
+      }
+
+      void acquire_fields (std::string& fields) {
+        if (!m_free_fields.empty()) {
+          fields.swap(m_free_fields.back());
+          m_free_fields.pop_back();
+        }
+      }
+
+      void release_fields (std::string& fields) {
+        if (fields.capacity() && (m_free_fields.size() < max_pooled_buffers)) {
+          fields.clear();
+          m_free_fields.emplace_back(std::move(fields));
+        }
+      }
+
+      std::vector<std::unique_ptr<render_stream>> m_free;
+      std::vector<std::string> m_free_fields;
+    };
+
+    thread_local buffer_pool t_buffers;
+
+  } // namespace
+
   recorder::recorder (logging::level lvl)
-    : m_time_point(std::chrono::system_clock::now())
-    , m_level(lvl)
+    : m_level(lvl)
     , unescaped(false)
-  {}
+    , m_persist_timeout(0)
+  {
+    if (core::instance().is_enabled(lvl)) {
+      m_time_point = std::chrono::system_clock::now();
+      m_buffer = t_buffers.acquire();
+    }
+  }
 
   recorder::~recorder () {
-    core::instance().log(m_level, m_time_point, m_buffer.str());
+    if (!m_buffer) {
+      return;
+    }
+    const std::string_view message(m_buffer->data(), m_buffer->size());
+    if (m_persist_timeout.count() > 0) {
+      core::instance().log_persisted(m_level, m_time_point, message, m_fields).wait_for(m_persist_timeout);
+    } else {
+      core::instance().log(m_level, m_time_point, message, m_fields);
+    }
+    t_buffers.release(std::move(m_buffer));
+    t_buffers.release_fields(m_fields);
+  }
+
+  std::ostream& recorder::stream () {
+    if (m_buffer) {
+      return *m_buffer;
+    }
+    // swallows everything, one per thread since it keeps a state.
+    static thread_local std::ostream null_stream(nullptr);
+    return null_stream;
   }
 
   recorder& recorder::operator<< (const char value) {
-    if (unescaped) {
-      m_buffer << value;
-    } else {
-      escape_filter(m_buffer, value);
+    if (m_buffer) {
+      if (unescaped) {
+        *m_buffer << value;
+      } else {
+        escape_filter(*m_buffer, value);
+      }
     }
     return *this;
   }
 
   recorder& recorder::operator<< (char const* value) {
     if (value) {
+      operator<<(std::string_view(value));
+    }
+    return *this;
+  }
+
+  recorder& recorder::operator<< (std::string_view value) {
+    if (m_buffer) {
       if (unescaped) {
-        m_buffer << value;
+        *m_buffer << value;
       } else {
-        while (*value) {
-          escape_filter(m_buffer, *value);
-          ++value;
+        // write the runs without control characters at once.
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < value.size(); ++i) {
+          const char ch = value[i];
+          if ((ch == '\0') || ((ch >= '\a') && (ch <= '\r'))) {
+            m_buffer->write(value.data() + start, static_cast<std::streamsize>(i - start));
+            escape_filter(*m_buffer, ch);
+            start = i + 1;
+          }
         }
+        m_buffer->write(value.data() + start, static_cast<std::streamsize>(value.size() - start));
       }
     }
     return *this;
   }
 
+  bool recorder::has_default_format () const {
+    return (m_buffer->flags() == (std::ios_base::dec | std::ios_base::skipws)) && (m_buffer->width() == 0);
+  }
+
+  void recorder::write_signed (long long value) {
+    if (!has_default_format()) {
+      *m_buffer << value;
+      return;
+    }
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    m_buffer->write(buffer, result.ptr - buffer);
+  }
+
+  void recorder::write_unsigned (unsigned long long value) {
+    if (!has_default_format()) {
+      *m_buffer << value;
+      return;
+    }
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    m_buffer->write(buffer, result.ptr - buffer);
+  }
+
+  void recorder::write_floating (double value) {
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+    if (has_default_format()) {
+      // same as the default ostream output: %g with the stream precision.
+      char buffer[64];
+      const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                        std::chars_format::general, static_cast<int>(m_buffer->precision()));
+      if (result.ec == std::errc()) {
+        m_buffer->write(buffer, result.ptr - buffer);
+        return;
+      }
+    }
+#endif
+    *m_buffer << value;
+  }
+
+  void recorder::write_pointer (const void* value) {
+    if (!has_default_format() || !value) {
+      *m_buffer << value;
+      return;
+    }
+    char buffer[2 + 2 * sizeof(void*)] = { '0', 'x' };
+    const auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), reinterpret_cast<std::uintptr_t>(value), 16);
+    m_buffer->write(buffer, result.ptr - buffer);
+  }
+
   recorder& recorder::operator<< (const flush&) {
     core::instance().flush();
     return *this;
   }
 
+  recorder& recorder::operator<< (const field& f) {
+    if (m_buffer) {
+      if (m_fields.empty()) {
+        t_buffers.acquire_fields(m_fields);
+      }
+      encode_field(m_fields, f);
+    }
+    return *this;
+  }
+
+  recorder& recorder::operator<< (const persist& p) {
+    m_persist_timeout = p.m_timeout;
+    return *this;
+  }
+
   recorder& recorder::endl () {
-    m_buffer << std::endl;
+    if (m_buffer) {
+      *m_buffer << std::endl;
+    }
     return *this;
   }
 
@@ -23,13 +23,18 @@
 #include <exception>
 #include <string>
 #include <chrono>
-#include <sstream>
+#include <memory>
+#include <ratio>
+#include <string_view>
+#include <type_traits>
 
 // --------------------------------------------------------------------------
 //
 // Library includes
 //
 #include "log_level.h"
+#include "fields.h"
+#include "render_buffer.h"
 
 #ifdef WIN32
 #pragma warning (disable: 4251)
@@ -54,8 +59,21 @@ namespace logging {
 
   struct flush {};
 
+  /**
+    * Write the record through the priority lane and wait in the destructor
+    * of the recorder maximal timeout until it is written to the sinks.
+    */
+  struct persist {
+    explicit persist (std::chrono::milliseconds timeout = std::chrono::milliseconds(1000))
+      : m_timeout(timeout)
+    {}
+
+    std::chrono::milliseconds m_timeout;
+  };
+
   /**
     * Logging recorder. Capture data for one record.
+    * If no sink consumes the level, the recorder does nothing.
     */
   class LOGGING_EXPORT recorder {
   public:
@@ -64,7 +82,11 @@ namespace logging {
 
     ~recorder ();
 
-    /// universal shift operator for all types that are supported by the underlying ostream.
+    /**
+     * Universal shift operator for all types that are supported by the underlying ostream.
+     * Integers, floating point numbers, pointers and durations are written directly
+     * with std::to_chars, as long as the stream has its default format settings.
+     */
     template <typename T>
     recorder& operator<< (T const& value);
 
@@ -86,9 +108,24 @@ namespace logging {
      */
     recorder& operator<< (const std::string& value);
 
+    /**
+     * Specialized shift operator for std::string_views.
+     * If not in raw mode control characters will be escaped
+     */
+    recorder& operator<< (std::string_view value);
+
+    /**
+     * Shift operator for a structured field, e.g. << logging::field("user", id).
+     * The field is stored typed in the record and rendered by the sink formatter.
+     */
+    recorder& operator<< (const field& f);
+
     /// specialized shift operator for flush the cached entries.
     recorder& operator<< (const flush&);
 
+    /// specialized shift operator to wait until this record is written.
+    recorder& operator<< (const persist&);
+
     /// append new line to the record
     recorder& endl ();
 
@@ -101,6 +138,9 @@ namespace logging {
     /// return true if in raw mode
     bool is_raw () const;
 
+    /// return true if the record will be consumed by any sink
+    bool is_enabled () const;
+
     /// direct accesor to the underlying ostream.
     operator std::ostream& ();
 
@@ -108,10 +148,25 @@ namespace logging {
     std::ostream& stream ();
 
   private:
+    /// return true if numbers can be written without the stream, needs the buffer.
+    bool has_default_format () const;
+
+    void write_signed (long long value);
+    void write_unsigned (unsigned long long value);
+    void write_floating (double value);
+    void write_pointer (const void* value);
+
+    template <typename Rep, typename Period>
+    void write_duration (const std::chrono::duration<Rep, Period>& value);
+
     std::chrono::system_clock::time_point m_time_point;
     level m_level;
     bool unescaped;
-    std::ostringstream m_buffer;
+    std::chrono::milliseconds m_persist_timeout;
+    /// pooled buffer of the current thread, only set if the record is enabled.
+    std::unique_ptr<render_stream> m_buffer;
+    /// encoded structured fields, taken from the pool of the current thread with the first field.
+    std::string m_fields;
   };
 
   class null_recoder {
@@ -18,27 +18,87 @@
 
 namespace logging {
 
+  namespace detail {
+
+    template <typename T>
+    constexpr bool is_character = std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                                  std::is_same_v<T, unsigned char> || std::is_same_v<T, wchar_t> ||
+                                  std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+    /// integers, that the ostream prints as numbers.
+    template <typename T>
+    constexpr bool is_integer = std::is_integral_v<T> && !std::is_same_v<T, bool> && !is_character<T>;
+
+    /// object pointers, that the ostream prints as address.
+    template <typename T>
+    constexpr bool is_address = std::is_pointer_v<T> &&
+                                !std::is_function_v<std::remove_pointer_t<T>> &&
+                                !is_character<std::remove_cv_t<std::remove_pointer_t<T>>>;
+
+    template <typename T>
+    struct is_duration : std::false_type {};
+
+    template <typename Rep, typename Period>
+    struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+    template <typename Period>
+    constexpr const char* duration_suffix () { return nullptr; }
+
+    template <> constexpr const char* duration_suffix<std::nano> () { return "ns"; }
+    template <> constexpr const char* duration_suffix<std::micro> () { return "us"; }
+    template <> constexpr const char* duration_suffix<std::milli> () { return "ms"; }
+    template <> constexpr const char* duration_suffix<std::ratio<1>> () { return "s"; }
+    template <> constexpr const char* duration_suffix<std::ratio<60>> () { return "min"; }
+    template <> constexpr const char* duration_suffix<std::ratio<3600>> () { return "h"; }
+
+  } // namespace detail
+
   template <typename T>
   inline recorder& recorder::operator<< (T const& value) {
-    m_buffer << value;
+    if (m_buffer) {
+      if constexpr (detail::is_integer<T> && std::is_signed_v<T>) {
+        write_signed(value);
+      } else if constexpr (detail::is_integer<T>) {
+        write_unsigned(value);
+      } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        write_floating(value);
+      } else if constexpr (detail::is_address<T>) {
+        write_pointer(value);
+      } else if constexpr (detail::is_duration<T>::value) {
+        write_duration(value);
+      } else {
+        *m_buffer << value;
+      }
+    }
     return *this;
   }
 
-  inline recorder& recorder::operator<< (const std::string& value) {
-    return operator<<(value.c_str());
+  template <typename Rep, typename Period>
+  inline void recorder::write_duration (const std::chrono::duration<Rep, Period>& value) {
+    operator<<(value.count());
+    constexpr const char* suffix = detail::duration_suffix<typename Period::type>();
+    if constexpr (suffix != nullptr) {
+      *m_buffer << suffix;
+    } else {
+      *m_buffer << '[' << Period::num << '/' << Period::den << "]s";
+    }
   }
 
-  inline recorder::operator std::ostream& () {
-    return m_buffer;
+  inline recorder& recorder::operator<< (const std::string& value) {
+    return operator<<(std::string_view(value));
   }
 
-  inline std::ostream& recorder::stream () {
-    return m_buffer;
+  inline recorder::operator std::ostream& () {
+    return stream();
   }
 
   inline bool recorder::is_raw () const {
     return unescaped;
   }
 
+  inline bool recorder::is_enabled () const {
+    return static_cast<bool>(m_buffer);
+  }
+
 
 } // namespace logging
@@ -0,0 +1,129 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "logging-export.h"
+
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Growable stream buffer, that keeps its storage when cleared.
+    * Writes directly into the put area, grows only when it is full.
+    */
+  class render_buffer : public std::streambuf {
+  public:
+    const char* data () const {
+      return pbase() ? pbase() : m_data.data();
+    }
+
+    std::size_t size () const {
+      return static_cast<std::size_t>(pptr() - pbase());
+    }
+
+    void clear () {
+      if (!m_data.empty()) {
+        setp(&m_data[0], &m_data[0] + m_data.size());
+      }
+    }
+
+  protected:
+    int_type overflow (int_type c) override {
+      if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+      }
+      grow(1);
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+      return c;
+    }
+
+    std::streamsize xsputn (const char* s, std::streamsize n) override {
+      if (epptr() - pptr() < n) {
+        grow(static_cast<std::size_t>(n));
+      }
+      traits_type::copy(pptr(), s, static_cast<std::size_t>(n));
+      pbump(static_cast<int>(n));
+      return n;
+    }
+
+  private:
+    void grow (std::size_t n) {
+      const std::size_t used = size();
+      m_data.resize(std::max(std::max(m_data.size() * 2, min_size), used + n));
+      setp(&m_data[0], &m_data[0] + m_data.size());
+      pbump(static_cast<int>(used));
+    }
+
+    static constexpr std::size_t min_size = 256;
+
+    std::string m_data;
+  };
+
+  /**
+    * Output stream to render records into, before they are written or logged at once.
+    */
+  class render_stream : public std::ostream {
+  public:
+    render_stream ()
+      : std::ostream(&m_buffer)
+    {}
+
+    const char* data () const {
+      return m_buffer.data();
+    }
+
+    std::size_t size () const {
+      return m_buffer.size();
+    }
+
+    /// clear the content and the error state.
+    void clear () {
+      m_buffer.clear();
+      std::ostream::clear();
+    }
+
+    /// clear the content and restore the default format settings.
+    void reset () {
+      clear();
+      flags(std::ios_base::dec | std::ios_base::skipws);
+      precision(6);
+      width(0);
+      fill(' ');
+    }
+
+  private:
+    render_buffer m_buffer;
+  };
+
+} // namespace logging
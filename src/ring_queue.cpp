@@ -0,0 +1,246 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <thread>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "ring_queue.h"
+
+
+namespace logging {
+
+  namespace {
+
+    /// Number of empty polls before the consumer parks.
+    constexpr int spin_count = 64;
+
+  } // namespace
+
+  ring_queue::ring_queue (std::size_t capacity)
+    : m_cells(new cell[round_up_pow2(capacity)])
+    , m_mask(round_up_pow2(capacity) - 1)
+    , m_tail(0)
+    , m_head(0)
+    , m_parked(false)
+    , m_empty_waiters(0)
+    , m_max_records(0)
+    , m_max_bytes(0)
+    , m_policy(overflow_policy::block)
+    , m_drop_level(level::warning)
+    , m_bytes(0)
+  {
+    for (std::size_t i = 0; i <= m_mask; ++i) {
+      m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ring_queue::~ring_queue ()
+  {}
+
+  /// Enqueue an item, respects the limits and their overflow policy and wakes a parked dequeuer.
+  void ring_queue::enqueue (record&& t) {
+    while (is_full(t)) {
+      const overflow_policy policy = m_policy.load(std::memory_order_relaxed);
+      if ((policy == overflow_policy::drop_newest) ||
+          (policy == overflow_policy::drop_oldest) ||
+          ((policy == overflow_policy::drop_below_level) &&
+           (t.level() < m_drop_level.load(std::memory_order_relaxed)))) {
+        m_dropped.add(t.level());
+        return;
+      }
+      wake();
+      std::this_thread::yield();
+    }
+
+    std::size_t bytes = 0;
+    if (m_max_bytes.load(std::memory_order_relaxed) > 0) {
+      bytes = t.byte_size();
+      m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    cell* c = nullptr;
+    std::size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      c = &m_cells[pos & m_mask];
+      const std::size_t seq = c->m_sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // queue is full, give the consumer a chance to catch up.
+        wake();
+        std::this_thread::yield();
+        pos = m_tail.load(std::memory_order_relaxed);
+      } else {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+    c->m_bytes = bytes;
+    c->m_data = std::move(t);
+    c->m_sequence.store(pos + 1, std::memory_order_release);
+    wake();
+  }
+
+  /// Dequeue an item if available, else parks until a new item is enqueued.
+  record ring_queue::dequeue () {
+    record item;
+    for (int i = 0; i < spin_count; ++i) {
+      if (try_dequeue(item)) {
+        return item;
+      }
+    }
+    for (;;) {
+      wait_for_items(nullptr);
+      if (try_dequeue(item)) {
+        return item;
+      }
+    }
+  }
+
+  /// Dequeue an item if available and return true, else return false.
+  bool ring_queue::try_dequeue (record& t) {
+    const std::size_t pos = m_head.load(std::memory_order_relaxed);
+    cell& c = m_cells[pos & m_mask];
+    const std::size_t seq = c.m_sequence.load(std::memory_order_acquire);
+    if (seq != pos + 1) {
+      return false;
+    }
+    t = std::move(c.m_data);
+    if (c.m_bytes > 0) {
+      m_bytes.fetch_sub(c.m_bytes, std::memory_order_relaxed);
+    }
+    c.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+    m_head.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Move all available items to the end of items, returns the number of moved items.
+  std::size_t ring_queue::drain (std::vector<record>& items) {
+    // take at most one round, producers could keep the queue filled forever.
+    record item;
+    std::size_t count = 0;
+    while ((count <= m_mask) && try_dequeue(item)) {
+      items.emplace_back(std::move(item));
+      ++count;
+    }
+    return count;
+  }
+
+  /// Waits until the queue is empty for maximum timeout time span.
+  void ring_queue::wait_until_empty (const std::chrono::milliseconds& timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_empty_waiters;
+    m_empty_condition.wait_for(lock, timeout, [&]() {
+      return empty();
+    });
+    --m_empty_waiters;
+  }
+
+  /// Parks the consumer until an item is available, ready returns true or wake is called.
+  void ring_queue::wait_for_items (const std::function<bool()>& ready,
+                                   std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_parked.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (is_ready() || (ready && ready())) {
+      m_parked.store(false);
+      return;
+    }
+    if (m_empty_waiters.load() > 0) {
+      m_empty_condition.notify_all();
+    }
+    auto is_woken = [&] () -> bool {
+      return !m_parked.load();
+    };
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+      m_condition.wait(lock, is_woken);
+    } else if (!m_condition.wait_until(lock, deadline, is_woken)) {
+      m_parked.store(false);
+    }
+  }
+
+  bool ring_queue::is_ready () const {
+    const std::size_t pos = m_head.load(std::memory_order_relaxed);
+    return m_cells[pos & m_mask].m_sequence.load(std::memory_order_acquire) == pos + 1;
+  }
+
+  bool ring_queue::empty () const {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+  std::size_t ring_queue::capacity () const {
+    return m_mask + 1;
+  }
+
+  /// Set the additional capacity limits and the overflow policy.
+  void ring_queue::set_limits (const queue_limits& limits) {
+    m_max_records = limits.max_records;
+    m_max_bytes = limits.max_bytes;
+    m_policy = limits.policy;
+    m_drop_level = limits.drop_level;
+  }
+
+  /// Get the additional capacity limits and the overflow policy.
+  queue_limits ring_queue::get_limits () const {
+    queue_limits limits;
+    limits.max_records = m_max_records;
+    limits.max_bytes = m_max_bytes;
+    limits.policy = m_policy;
+    limits.drop_level = m_drop_level;
+    return limits;
+  }
+
+  /// Counters of the records dropped due to the limits.
+  const drop_counter& ring_queue::dropped () const {
+    return m_dropped;
+  }
+
+  bool ring_queue::is_full (const record& t) const {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    const std::size_t count = m_tail.load(std::memory_order_relaxed) - head;
+    if (count == 0) {
+      // always accept one item, even if it is bigger than max_bytes.
+      return false;
+    }
+    const std::size_t max_records = m_max_records.load(std::memory_order_relaxed);
+    const std::size_t max_bytes = m_max_bytes.load(std::memory_order_relaxed);
+    return (count > m_mask) ||
+           ((max_records > 0) && (count >= max_records)) ||
+           ((max_bytes > 0) && (m_bytes.load(std::memory_order_relaxed) + t.byte_size() > max_bytes));
+  }
+
+  /// Wake the consumer, if it is parked in dequeue or wait_for_items.
+  void ring_queue::wake () {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked.load(std::memory_order_relaxed) && m_parked.exchange(false)) {
+      {
+        // wait until the consumer really sleeps, to not loose the signal.
+        std::lock_guard<std::mutex> lock(m_mutex);
+      }
+      m_condition.notify_one();
+    }
+  }
+
+} // namespace logging
@@ -0,0 +1,193 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#if defined USE_MINGW && __MINGW_GCC_VERSION < 100000
+#include <mingw/mingw.condition_variable.h>
+#include <mingw/mingw.mutex.h>
+#endif
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "record.h"
+#include "queue_limits.h"
+
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+#ifndef LOGGING_QUEUE_CAPACITY
+# define LOGGING_QUEUE_CAPACITY 4096
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /// Round up to the next power of two, used for the capacity of the ring buffers.
+  inline std::size_t round_up_pow2 (std::size_t n) {
+    std::size_t r = 2;
+    while (r < n) {
+      r <<= 1;
+    }
+    return r;
+  }
+
+  /**
+    * Bounded lock free multi producer / single consumer fifo queue.
+    *
+    * The slots are preallocated at construction. Producers claim a slot with
+    * a single compare and swap on the tail and never take a mutex while the
+    * consumer is running. The consumer only parks, when the queue is empty.
+    * Only the one producer, that finds the consumer parked, takes the park
+    * mutex to hand over the wake up.
+    *
+    * Additional limits for the number of items and bytes can be set. Since
+    * producers can not remove items, overflow_policy::drop_oldest behaves
+    * like overflow_policy::drop_newest.
+    */
+  class LOGGING_EXPORT ring_queue {
+  public:
+    /// Construct the queue, capacity will be rounded up to the next power of two.
+    explicit ring_queue (std::size_t capacity = LOGGING_QUEUE_CAPACITY);
+
+    ~ring_queue ();
+
+    /// Enqueue an item, respects the limits and their overflow policy and wakes a parked dequeuer.
+    void enqueue (record&& t);
+
+    /// Dequeue an item if available, else parks until a new item is enqueued.
+    record dequeue ();
+
+    /// Dequeue an item if available and return true, else return false.
+    bool try_dequeue (record& t);
+
+    /// Move all available items to the end of items, returns the number of moved items.
+    std::size_t drain (std::vector<record>& items);
+
+    /// Waits until the queue is empty for maximum timeout time span.
+    void wait_until_empty (const std::chrono::milliseconds& timeout);
+
+    /// Parks the consumer until an item is available, ready returns true, wake is called or the deadline is reached.
+    void wait_for_items (const std::function<bool()>& ready,
+                         std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    /// Wake the consumer, if it is parked in dequeue or wait_for_items.
+    void wake ();
+
+    /// Return true if there is no item in the queue.
+    bool empty () const;
+
+    /**
+      * Call f for each published item without dequeuing it.
+      * Does not block or allocate, for a crash handler that can not wait for the consumer.
+      * A concurrent consumer can take the items while they are visited.
+      */
+    template<typename F>
+    void for_each_pending (F f) const {
+      const std::size_t head = m_head.load(std::memory_order_acquire);
+      const std::size_t tail = m_tail.load(std::memory_order_acquire);
+      for (std::size_t pos = head; (pos != tail) && (pos - head <= m_mask); ++pos) {
+        const cell& c = m_cells[pos & m_mask];
+        if (c.m_sequence.load(std::memory_order_acquire) != pos + 1) {
+          break;
+        }
+        f(c.m_data);
+      }
+    }
+
+    /// Number of preallocated slots.
+    std::size_t capacity () const;
+
+    /// Set the additional capacity limits and the overflow policy.
+    void set_limits (const queue_limits& limits);
+
+    /// Get the additional capacity limits and the overflow policy.
+    queue_limits get_limits () const;
+
+    /// Counters of the records dropped due to the limits.
+    const drop_counter& dropped () const;
+
+    ring_queue (const ring_queue&) = delete;
+    void operator= (const ring_queue&) = delete;
+
+  private:
+    /// Return true if the next item is ready to be dequeued.
+    bool is_ready () const;
+
+    /// Return true if t does not fit into the limits.
+    bool is_full (const record& t) const;
+
+    struct alignas(cache_line_size) cell {
+      std::atomic<std::size_t> m_sequence;
+      std::size_t m_bytes;
+      record m_data;
+    };
+
+    /// Preallocated slots.
+    std::unique_ptr<cell[]> m_cells;
+    const std::size_t m_mask;
+
+    /// Next position to claim, shared by all producers.
+    alignas(cache_line_size) std::atomic<std::size_t> m_tail;
+
+    /// Next position to read, only written by the consumer.
+    alignas(cache_line_size) std::atomic<std::size_t> m_head;
+
+    /// True while the consumer waits for new items.
+    alignas(cache_line_size) std::atomic_bool m_parked;
+
+    /// Number of threads waiting in wait_until_empty.
+    std::atomic_uint m_empty_waiters;
+
+    /// Limits, only read by the producers.
+    std::atomic<std::size_t> m_max_records;
+    std::atomic<std::size_t> m_max_bytes;
+    std::atomic<overflow_policy> m_policy;
+    std::atomic<level> m_drop_level;
+
+    /// Bytes of the queued items, only counted while max bytes is limited.
+    std::atomic<std::size_t> m_bytes;
+
+    drop_counter m_dropped;
+
+    /// Condition to signal new item to a parked dequeuer.
+    std::condition_variable m_condition;
+
+    /// Condition to signal an empty queue.
+    std::condition_variable m_empty_condition;
+
+    /// Mutex to park the consumer, never taken by a producer on the hot path.
+    std::mutex m_mutex;
+
+  };
+
+} // namespace logging
@@ -0,0 +1,248 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#ifdef WIN32
+# include <process.h>
+#else
+# include <unistd.h>
+#endif
+#if defined USE_MINGW && __MINGW_GCC_VERSION < 100000
+#include <mingw/mingw.thread.h>
+#include <mingw/mingw.mutex.h>
+#include <mingw/mingw.condition_variable.h>
+#endif
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "rotating_file_logger.h"
+
+
+namespace logging {
+
+  namespace {
+
+    long process_id () {
+#ifdef WIN32
+      return static_cast<long>(_getpid());
+#else
+      return static_cast<long>(getpid());
+#endif
+    }
+
+  } // namespace
+
+  /**
+    * Shifts the numbered files of rotated files in an own thread.
+    * Without thread support the files are shifted directly.
+    */
+  class rotation_worker {
+  public:
+    rotation_worker (const std::string& name, int max_files)
+      : m_name(name)
+      , m_max_files(max_files)
+#ifndef LOGGING_NO_THREAD
+      , m_is_active(true)
+      , m_busy(false)
+#endif //LOGGING_NO_THREAD
+    {
+#ifndef LOGGING_NO_THREAD
+      m_thread = std::thread([this] () { run(); });
+#endif //LOGGING_NO_THREAD
+    }
+
+    ~rotation_worker () {
+#ifndef LOGGING_NO_THREAD
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_active = false;
+      }
+      m_condition.notify_all();
+      m_thread.join();
+#endif //LOGGING_NO_THREAD
+    }
+
+    void add (const std::string& pending) {
+#ifndef LOGGING_NO_THREAD
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(pending);
+      }
+      m_condition.notify_all();
+#else
+      // called while the core writes the sink, errors must not be logged to the core again.
+      core::rotate_file_with_max_count(m_name, pending, m_max_files, false);
+#endif //LOGGING_NO_THREAD
+    }
+
+    void wait () {
+#ifndef LOGGING_NO_THREAD
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this] () { return m_pending.empty() && !m_busy; });
+#endif //LOGGING_NO_THREAD
+    }
+
+  private:
+#ifndef LOGGING_NO_THREAD
+    void run () {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      for (;;) {
+        m_condition.wait(lock, [this] () { return !m_pending.empty() || !m_is_active; });
+        if (m_pending.empty()) {
+          break;
+        }
+        const std::string pending = m_pending.front();
+        m_pending.pop_front();
+        m_busy = true;
+        lock.unlock();
+        core::rotate_file_with_max_count(m_name, pending, m_max_files);
+        lock.lock();
+        m_busy = false;
+        m_condition.notify_all();
+      }
+    }
+#endif //LOGGING_NO_THREAD
+
+    const std::string m_name;
+    const int m_max_files;
+#ifndef LOGGING_NO_THREAD
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::string> m_pending;
+    bool m_is_active;
+    bool m_busy;
+    std::thread m_thread;
+#endif //LOGGING_NO_THREAD
+  };
+
+  rotating_file_buffer::rotating_file_buffer ()
+    : m_size(0)
+    , m_at_line_start(true)
+    , m_rotations(0)
+  {}
+
+  rotating_file_buffer::~rotating_file_buffer () {
+    close();
+  }
+
+  bool rotating_file_buffer::open (const std::string& name, const rotation_policy& policy) {
+    close();
+    m_name = name;
+    m_policy = policy;
+    if (!m_file.open(name, std::ios_base::out | std::ios_base::app | std::ios_base::binary)) {
+      return false;
+    }
+    m_size = static_cast<std::size_t>(m_file.pubseekoff(0, std::ios_base::end, std::ios_base::out));
+    m_next_rotation = std::chrono::system_clock::now() + m_policy.interval;
+    m_at_line_start = true;
+    m_rotations = 0;
+    m_worker.reset(new rotation_worker(name, policy.max_files));
+    return true;
+  }
+
+  void rotating_file_buffer::close () {
+    m_file.close();
+    m_worker.reset();
+  }
+
+  bool rotating_file_buffer::is_open () const {
+    return m_file.is_open();
+  }
+
+  unsigned int rotating_file_buffer::rotations () const {
+    return m_rotations;
+  }
+
+  void rotating_file_buffer::wait_for_rotations () {
+    if (m_worker) {
+      m_worker->wait();
+    }
+  }
+
+  bool rotating_file_buffer::sync_to_storage () {
+    return m_file.sync_to_storage();
+  }
+
+  int rotating_file_buffer::emergency_fd () const {
+    return m_file.emergency_fd();
+  }
+
+  rotating_file_buffer::int_type rotating_file_buffer::overflow (int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    check_rotation();
+    const char ch = traits_type::to_char_type(c);
+    if (traits_type::eq_int_type(m_file.sputc(ch), traits_type::eof())) {
+      return traits_type::eof();
+    }
+    ++m_size;
+    m_at_line_start = (ch == '\n');
+    return c;
+  }
+
+  std::streamsize rotating_file_buffer::xsputn (const char* s, std::streamsize n) {
+    if (n <= 0) {
+      return 0;
+    }
+    check_rotation();
+    const std::streamsize written = m_file.sputn(s, n);
+    m_size += static_cast<std::size_t>(written);
+    m_at_line_start = (written == n) && (s[n - 1] == '\n');
+    return written;
+  }
+
+  int rotating_file_buffer::sync () {
+    return m_file.pubsync();
+  }
+
+  void rotating_file_buffer::check_rotation () {
+    if (!m_at_line_start || (m_size == 0)) {
+      return;
+    }
+    if (((m_policy.max_bytes > 0) && (m_size >= m_policy.max_bytes)) ||
+        ((m_policy.interval.count() > 0) && (std::chrono::system_clock::now() >= m_next_rotation))) {
+      rotate();
+    }
+  }
+
+  void rotating_file_buffer::rotate () {
+    m_file.close();
+    ++m_rotations;
+    // only one rename here, the numbered files are shifted in the background.
+    // the pending name is unique per process and time, so leftovers of a crashed run are not overwritten.
+    const auto now = std::chrono::system_clock::now().time_since_epoch().count();
+    const std::string pending = m_name + ".rotating." + std::to_string(process_id()) + '.' +
+                                std::to_string(now) + '.' + std::to_string(m_rotations);
+    if (std::rename(m_name.c_str(), pending.c_str()) == 0) {
+      m_worker->add(pending);
+    }
+    m_file.open(m_name, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+    m_size = 0;
+    m_next_rotation = std::chrono::system_clock::now() + m_policy.interval;
+  }
+
+} // namespace logging
@@ -0,0 +1,143 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * When a rotating log file is rotated.
+    */
+  struct rotation_policy {
+    /// Rotate when the file reaches this size. 0 means no size limit.
+    std::size_t max_bytes = 0;
+
+    /// Rotate after this time span since the file was opened. 0 means no time limit.
+    std::chrono::system_clock::duration interval{0};
+
+    /// Number of rotated files to keep, see core::rename_file_with_max_count.
+    int max_files = 5;
+  };
+
+  class rotation_worker;
+
+  /**
+    * Stream buffer that writes to a file and rotates it by size and time.
+    *
+    * A rotation happens only at the start of a line. The current file is
+    * renamed to a pending name and a new file is opened, the numbered files
+    * are shifted by a background thread, so writing never waits for them.
+    */
+  class LOGGING_EXPORT rotating_file_buffer : public std::streambuf, public durable_buffer {
+  public:
+    rotating_file_buffer ();
+
+    /// closes the file and waits for the pending rotations.
+    ~rotating_file_buffer ();
+
+    /// open the file to append, returns false on error.
+    bool open (const std::string& name, const rotation_policy& policy);
+
+    /// close the file and wait for the pending rotations.
+    void close ();
+
+    bool is_open () const;
+
+    /// number of rotations since the file was opened.
+    unsigned int rotations () const;
+
+    /// wait until the background thread has shifted all rotated files.
+    void wait_for_rotations ();
+
+    bool sync_to_storage () override;
+
+    int emergency_fd () const override;
+
+    rotating_file_buffer (const rotating_file_buffer&) = delete;
+    void operator= (const rotating_file_buffer&) = delete;
+
+  protected:
+    int_type overflow (int_type c) override;
+    std::streamsize xsputn (const char* s, std::streamsize n) override;
+    int sync () override;
+
+  private:
+    /// rotate before the next line, if the size or the time limit is reached.
+    void check_rotation ();
+
+    void rotate ();
+
+    std::string m_name;
+    rotation_policy m_policy;
+    durable_filebuf m_file;
+    std::size_t m_size;
+    std::chrono::system_clock::time_point m_next_rotation;
+    bool m_at_line_start;
+    unsigned int m_rotations;
+    std::unique_ptr<rotation_worker> m_worker;
+  };
+
+  /**
+    * log to a file, that is rotated automatically by size and time.
+    * Automatic adds and remove itself to the logging core.
+    */
+  class rotating_file_logger {
+  public:
+    rotating_file_logger (const std::string& name, level lvl, const record_formatter& fmt,
+                          const rotation_policy& policy,
+                          const flush_policy& flush = flush_policy())
+      : stream(&buffer)
+    {
+      if (buffer.open(name, policy)) {
+        core::instance().add_sink(&stream, lvl, fmt, flush);
+      }
+    }
+
+    ~rotating_file_logger () {
+      core::instance().remove_sink(&stream);
+      buffer.close();
+    }
+
+  private:
+    rotating_file_buffer buffer;
+    std::ostream stream;
+  };
+
+} // namespace logging
@@ -0,0 +1,77 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "staging_buffer.h"
+
+
+namespace logging {
+
+  staging_buffer::staging_buffer (std::size_t capacity)
+    : m_slots(new record[round_up_pow2(capacity)])
+    , m_mask(round_up_pow2(capacity) - 1)
+    , m_tail(0)
+    , m_head_cache(0)
+    , m_head(0)
+    , m_tail_cache(0)
+    , m_closed(false)
+  {}
+
+  staging_buffer::~staging_buffer ()
+  {}
+
+  bool staging_buffer::try_enqueue (record& t) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache > m_mask) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+      if (tail - m_head_cache > m_mask) {
+        return false;
+      }
+    }
+    m_slots[tail & m_mask] = std::move(t);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool staging_buffer::try_dequeue (record& t) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache) {
+      m_tail_cache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tail_cache) {
+        return false;
+      }
+    }
+    t = std::move(m_slots[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool staging_buffer::empty () const {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+  void staging_buffer::close () {
+    m_closed.store(true, std::memory_order_release);
+  }
+
+  bool staging_buffer::is_closed () const {
+    return m_closed.load(std::memory_order_acquire);
+  }
+
+} // namespace logging
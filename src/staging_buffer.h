@@ -0,0 +1,102 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <memory>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "ring_queue.h"
+
+
+#ifdef WIN32
+#pragma warning (disable: 4251)
+#endif
+
+#ifndef LOGGING_STAGING_CAPACITY
+# define LOGGING_STAGING_CAPACITY 1024
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Bounded single producer / single consumer fifo queue.
+    *
+    * Owned by one logging thread and drained by the sink thread. No operation
+    * blocks, the caller decides what to do with a full or an empty buffer.
+    */
+  class LOGGING_EXPORT staging_buffer {
+  public:
+    /// Construct the buffer, capacity will be rounded up to the next power of two.
+    explicit staging_buffer (std::size_t capacity = LOGGING_STAGING_CAPACITY);
+
+    ~staging_buffer ();
+
+    /// Move the item into the buffer and return true, if the buffer is full, t is untouched and false is returned.
+    bool try_enqueue (record& t);
+
+    /// Dequeue an item if available and return true, else return false.
+    bool try_dequeue (record& t);
+
+    /// Return true if there is no item in the buffer.
+    bool empty () const;
+
+    /// Call f for each item without dequeuing it, does not block or allocate.
+    template<typename F>
+    void for_each_pending (F f) const {
+      const std::size_t head = m_head.load(std::memory_order_acquire);
+      const std::size_t tail = m_tail.load(std::memory_order_acquire);
+      for (std::size_t pos = head; (pos != tail) && (pos - head <= m_mask); ++pos) {
+        f(m_slots[pos & m_mask]);
+      }
+    }
+
+    /// Mark the buffer as abandoned by its producer, the remaining items are still dequeueable.
+    void close ();
+
+    /// Return true if the producer will not enqueue any more items.
+    bool is_closed () const;
+
+    staging_buffer (const staging_buffer&) = delete;
+    void operator= (const staging_buffer&) = delete;
+
+  private:
+    std::unique_ptr<record[]> m_slots;
+    const std::size_t m_mask;
+
+    /// Producer side: next position to write and last seen consumer position.
+    alignas(cache_line_size) std::atomic<std::size_t> m_tail;
+    std::size_t m_head_cache;
+
+    /// Consumer side: next position to read and last seen producer position.
+    alignas(cache_line_size) std::atomic<std::size_t> m_head;
+    std::size_t m_tail_cache;
+
+    alignas(cache_line_size) std::atomic_bool m_closed;
+  };
+
+} // namespace logging
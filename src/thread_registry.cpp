@@ -0,0 +1,139 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef WIN32
+# include <windows.h>
+#elif defined __linux__
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "thread_registry.h"
+
+
+namespace logging {
+
+  namespace {
+
+    /**
+      * Table of the interned names. Names are only added and live as long as
+      * the table, so readers can use them without a lock.
+      */
+    class name_table {
+    public:
+      name_table ()
+        : m_count(0)
+      {
+        for (auto& n : m_names) {
+          n.store(nullptr, std::memory_order_relaxed);
+        }
+        add("main");
+      }
+
+      std::uint32_t add (std::string_view name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::uint32_t count = m_count.load(std::memory_order_relaxed);
+        for (std::uint32_t i = 0; i < count; ++i) {
+          if (*m_names[i].load(std::memory_order_relaxed) == name) {
+            return i;
+          }
+        }
+        if (count == LOGGING_MAX_THREAD_NAMES) {
+          return 0;
+        }
+        m_storage.emplace_back(name);
+        m_names[count].store(&m_storage.back(), std::memory_order_release);
+        m_count.store(count + 1, std::memory_order_release);
+        return count;
+      }
+
+      std::string_view get (std::uint32_t id) const {
+        if (id < LOGGING_MAX_THREAD_NAMES) {
+          const std::string* name = m_names[id].load(std::memory_order_acquire);
+          if (name) {
+            return *name;
+          }
+        }
+        return "?";
+      }
+
+      static name_table& instance () {
+        static name_table table;
+        return table;
+      }
+
+    private:
+      std::atomic<const std::string*> m_names[LOGGING_MAX_THREAD_NAMES];
+      std::atomic<std::uint32_t> m_count;
+      std::deque<std::string> m_storage;
+      std::mutex m_mutex;
+    };
+
+#if (defined WIN32 || defined _WIN32 || defined WINCE || defined __CYGWIN__) && !defined(thread_local) && !defined(USE_MINGW)
+# define thread_local __declspec(thread)
+#endif
+
+    thread_local std::uint32_t t_thread_id = 0;
+    thread_local std::uint32_t t_os_id = 0;
+
+  } // namespace
+
+  std::uint32_t thread_registry::register_name (std::string_view name) {
+    return name_table::instance().add(name);
+  }
+
+  std::string_view thread_registry::name (std::uint32_t id) {
+    return name_table::instance().get(id);
+  }
+
+  std::uint32_t thread_registry::set_current_name (std::string_view name) {
+    t_thread_id = register_name(name);
+    return t_thread_id;
+  }
+
+  std::uint32_t thread_registry::current_id () {
+    return t_thread_id;
+  }
+
+  std::uint32_t thread_registry::current_os_id () {
+    if (t_os_id == 0) {
+#ifdef WIN32
+      t_os_id = static_cast<std::uint32_t>(GetCurrentThreadId());
+#elif defined __linux__
+      t_os_id = static_cast<std::uint32_t>(syscall(SYS_gettid));
+#else
+      t_os_id = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+    }
+    return t_os_id;
+  }
+
+} // namespace logging
@@ -0,0 +1,68 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstdint>
+#include <string_view>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "logging-export.h"
+
+#ifndef LOGGING_MAX_THREAD_NAMES
+# define LOGGING_MAX_THREAD_NAMES 1024
+#endif
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Registry of interned thread names.
+    *
+    * A name is registered once and gets a small id, records only carry
+    * this id. The name of an id is resolved without a lock. Id 0 is the
+    * name "main", used by all threads without an own name and when the
+    * registry is full.
+    */
+  struct LOGGING_EXPORT thread_registry {
+
+    /// Intern the name and return its id, the same name always gets the same id.
+    static std::uint32_t register_name (std::string_view name);
+
+    /// Name of the thread id, "?" for unknown ids.
+    static std::string_view name (std::uint32_t id);
+
+    /// Set the name of the current thread, returns its id.
+    static std::uint32_t set_current_name (std::string_view name);
+
+    /// Id of the name of the current thread.
+    static std::uint32_t current_id ();
+
+    /// Thread id of the operating system of the current thread.
+    static std::uint32_t current_os_id ();
+
+  };
+
+} // namespace logging
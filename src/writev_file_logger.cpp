@@ -0,0 +1,226 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "writev_file_logger.h"
+
+#ifndef IOV_MAX
+# define IOV_MAX 1024
+#endif
+
+namespace logging {
+
+  writev_file_buffer::writev_file_buffer ()
+    : m_fd(-1)
+    , m_chunk_size(0)
+    , m_write_calls(0)
+#ifndef LOGGING_NO_THREAD
+    , m_pending(false)
+    , m_is_active(false)
+#endif //LOGGING_NO_THREAD
+  {}
+
+  writev_file_buffer::~writev_file_buffer () {
+    close();
+  }
+
+  bool writev_file_buffer::open (const std::string& name, std::size_t chunk_size) {
+    close();
+    m_fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+      return false;
+    }
+    m_chunk_size = std::max<std::size_t>(chunk_size, 256);
+    m_write_calls = 0;
+    m_current = batch();
+    m_in_flight = batch();
+    next_chunk();
+#ifndef LOGGING_NO_THREAD
+    m_pending = false;
+    m_is_active = true;
+    m_writer = std::thread([this] () { writer_call(); });
+#endif //LOGGING_NO_THREAD
+    return true;
+  }
+
+  void writev_file_buffer::close () {
+    if (m_fd < 0) {
+      return;
+    }
+    submit();
+#ifndef LOGGING_NO_THREAD
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_is_active = false;
+    }
+    m_condition.notify_all();
+    m_writer.join();
+#endif //LOGGING_NO_THREAD
+    ::close(m_fd);
+    m_fd = -1;
+    setp(nullptr, nullptr);
+  }
+
+  bool writev_file_buffer::is_open () const {
+    return m_fd >= 0;
+  }
+
+  std::size_t writev_file_buffer::write_calls () const {
+    return m_write_calls;
+  }
+
+  bool writev_file_buffer::sync_to_storage () {
+    if (m_fd < 0) {
+      return false;
+    }
+    submit();
+    wait_for_writer();
+    return sync_file(m_fd);
+  }
+
+  int writev_file_buffer::emergency_fd () const {
+    return m_fd;
+  }
+
+  writev_file_buffer::int_type writev_file_buffer::overflow (int_type c) {
+    if (m_fd < 0) {
+      return traits_type::eof();
+    }
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    next_chunk();
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+  }
+
+  int writev_file_buffer::sync () {
+    if (m_fd < 0) {
+      return -1;
+    }
+    submit();
+    return 0;
+  }
+
+  void writev_file_buffer::next_chunk () {
+    if (m_current.m_count > 0) {
+      m_current.m_used[m_current.m_count - 1] = static_cast<std::size_t>(pptr() - pbase());
+    }
+    if (m_current.m_count == m_current.m_chunks.size()) {
+      m_current.m_chunks.emplace_back(m_chunk_size, '\0');
+      m_current.m_used.push_back(0);
+    }
+    std::string& chunk = m_current.m_chunks[m_current.m_count++];
+    setp(&chunk[0], &chunk[0] + chunk.size());
+  }
+
+  void writev_file_buffer::submit () {
+    m_current.m_used[m_current.m_count - 1] = static_cast<std::size_t>(pptr() - pbase());
+    if ((m_current.m_count == 1) && (m_current.m_used[0] == 0)) {
+      return;
+    }
+#ifndef LOGGING_NO_THREAD
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this] () { return !m_pending; });
+      std::swap(m_current, m_in_flight);
+      m_pending = true;
+    }
+    m_condition.notify_all();
+#else
+    write_batch(m_current);
+#endif //LOGGING_NO_THREAD
+    m_current.m_count = 0;
+    next_chunk();
+  }
+
+  void writev_file_buffer::wait_for_writer () {
+#ifndef LOGGING_NO_THREAD
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this] () { return !m_pending; });
+#endif //LOGGING_NO_THREAD
+  }
+
+  void writev_file_buffer::write_batch (batch& b) {
+    std::vector<iovec> iov;
+    iov.reserve(b.m_count);
+    for (std::size_t i = 0; i < b.m_count; ++i) {
+      if (b.m_used[i] > 0) {
+        iov.push_back({ &b.m_chunks[i][0], b.m_used[i] });
+      }
+    }
+    std::size_t first = 0;
+    while (first < iov.size()) {
+      const int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+      const ssize_t written = ::writev(m_fd, &iov[first], count);
+      ++m_write_calls;
+      if (written <= 0) {
+        if ((written < 0) && (errno == EINTR)) {
+          continue;
+        }
+        break;
+      }
+      // skip the written buffers and continue after a partial write.
+      std::size_t rest = static_cast<std::size_t>(written);
+      while ((first < iov.size()) && (rest >= iov[first].iov_len)) {
+        rest -= iov[first].iov_len;
+        ++first;
+      }
+      if (rest > 0) {
+        iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + rest;
+        iov[first].iov_len -= rest;
+      }
+    }
+    b.m_count = 0;
+  }
+
+#ifndef LOGGING_NO_THREAD
+  void writev_file_buffer::writer_call () {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      m_condition.wait(lock, [this] () { return m_pending || !m_is_active; });
+      if (!m_pending) {
+        break;
+      }
+      lock.unlock();
+      write_batch(m_in_flight);
+      lock.lock();
+      m_pending = false;
+      m_condition.notify_all();
+    }
+  }
+#endif //LOGGING_NO_THREAD
+
+} // namespace logging
+
+#endif // WIN32
@@ -0,0 +1,157 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     C++ logger
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+#ifndef WIN32
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "core.h"
+
+/**
+* Provides an API for stream logging to multiple sinks.
+*/
+namespace logging {
+
+  /**
+    * Stream buffer that collects the output between two flushes and writes
+    * it with one writev call.
+    *
+    * The output is collected in chunks of a fixed size, a flush hands the
+    * chunks to a writer thread and continues with a second set of chunks,
+    * so the next batch is prepared while the previous is written.
+    * Without thread support the chunks are written directly.
+    */
+  class LOGGING_EXPORT writev_file_buffer : public std::streambuf, public durable_buffer {
+  public:
+    writev_file_buffer ();
+
+    /// writes the pending output and closes the file.
+    ~writev_file_buffer ();
+
+    /// open the file to append, returns false on error.
+    bool open (const std::string& name, std::size_t chunk_size = 64 * 1024);
+
+    /// write the pending output and close the file.
+    void close ();
+
+    bool is_open () const;
+
+    /// number of writev calls since the file was opened.
+    std::size_t write_calls () const;
+
+    /// write the pending output, wait for the writer and sync the file.
+    bool sync_to_storage () override;
+
+    int emergency_fd () const override;
+
+    writev_file_buffer (const writev_file_buffer&) = delete;
+    void operator= (const writev_file_buffer&) = delete;
+
+  protected:
+    int_type overflow (int_type c) override;
+    int sync () override;
+
+  private:
+    /// output between two flushes.
+    struct batch {
+      std::vector<std::string> m_chunks;
+      std::vector<std::size_t> m_used;
+      std::size_t m_count = 0;
+    };
+
+    /// continue in the next chunk of the current batch.
+    void next_chunk ();
+
+    /// wait until the writer is idle, then hand the current batch over.
+    void submit ();
+
+    /// wait until the writer has written the submitted batch.
+    void wait_for_writer ();
+
+    /// write all chunks of the batch with writev.
+    void write_batch (batch& b);
+
+#ifndef LOGGING_NO_THREAD
+    void writer_call ();
+#endif //LOGGING_NO_THREAD
+
+    int m_fd;
+    std::size_t m_chunk_size;
+    std::atomic<std::size_t> m_write_calls;
+    batch m_current;
+    batch m_in_flight;
+
+#ifndef LOGGING_NO_THREAD
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_pending;
+    bool m_is_active;
+    std::thread m_writer;
+#endif //LOGGING_NO_THREAD
+  };
+
+  /**
+    * log to a file with one writev call per flushed batch.
+    * The default policy flushes once per batch, so a batch costs one syscall.
+    * Automatic adds and remove itself to the logging core.
+    */
+  class writev_file_logger {
+  public:
+    writev_file_logger (const std::string& name, level lvl, const record_formatter& fmt,
+                        const flush_policy& flush = flush_policy::batched())
+      : stream(&buffer)
+    {
+      if (buffer.open(name)) {
+        core::instance().add_sink(&stream, lvl, fmt, flush);
+      }
+    }
+
+    ~writev_file_logger () {
+      core::instance().remove_sink(&stream);
+      buffer.close();
+    }
+
+    /// number of writev calls since the file was opened.
+    std::size_t write_calls () const {
+      return buffer.write_calls();
+    }
+
+  private:
+    writev_file_buffer buffer;
+    std::ostream stream;
+  };
+
+} // namespace logging
+
+#endif // WIN32
@@ -0,0 +1,637 @@
+
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <testing/testing.h>
+#include "logger.h"
+#include "core.h"
+
+DEFINE_LOGGING_CORE()
+
+// --------------------------------------------------------------------------
+void test_staging () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, [] (std::ostream& out, const logging::record& e) {
+    out << e.line() << '\n';
+  });
+  core.set_staging(true);
+
+  const int threads = 4;
+  const int count = 2000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&] () {
+      for (int i = 0; i < count; ++i) {
+        logging::info() << i;
+      }
+    });
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
+  // the threads are gone, their left over records must still arrive.
+  core.flush();
+  core.set_staging(false);
+  core.remove_sink(&buffer);
+
+  std::istringstream in(buffer.str());
+  int lines = 0;
+  unsigned int id = 0;
+  while (in >> id) {
+    ++lines;
+  }
+  EXPECT_EQUAL(lines, threads * count);
+}
+
+// --------------------------------------------------------------------------
+void test_dropped_report () {
+#ifndef LOGGING_NO_THREAD
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  std::mutex stuck;
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, [&] (std::ostream& out, const logging::record& e) {
+    std::lock_guard<std::mutex> lock(stuck);
+    out << e.message() << '\n';
+  });
+
+  logging::queue_limits limits;
+  limits.max_records = 4;
+  limits.policy = logging::overflow_policy::drop_newest;
+  core.set_queue_limits(limits);
+
+  const std::size_t dropped = core.get_dropped_count(logging::level::info);
+  const std::size_t dropped_errors = core.get_dropped_count(logging::level::error);
+  {
+    std::lock_guard<std::mutex> lock(stuck);
+    for (int i = 0; i < 20; ++i) {
+      logging::info() << i;
+    }
+    // the priority lane is limited, too.
+    for (int i = 0; i < 20; ++i) {
+      logging::error() << i;
+    }
+  }
+  core.flush();
+  core.set_queue_limits(logging::queue_limits());
+  core.remove_sink(&buffer);
+
+  EXPECT_TRUE(core.get_dropped_count(logging::level::info) > dropped);
+  EXPECT_TRUE(core.get_dropped_count(logging::level::error) > dropped_errors);
+  EXPECT_REGEX(buffer.str(), std::string("(.|\n)*[0-9]+ records dropped due to the queue limits \\(info : [0-9]+, error: [0-9]+\\)\n"));
+#endif // LOGGING_NO_THREAD
+}
+
+// --------------------------------------------------------------------------
+void test_priority_lane () {
+#ifndef LOGGING_NO_THREAD
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  std::mutex stuck;
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, [&] (std::ostream& out, const logging::record& e) {
+    std::lock_guard<std::mutex> lock(stuck);
+    out << e.message() << '\n';
+  });
+
+  std::chrono::steady_clock::duration error_time;
+  {
+    std::lock_guard<std::mutex> lock(stuck);
+    for (int i = 0; i < 10; ++i) {
+      logging::info() << "info";
+    }
+    const auto start = std::chrono::steady_clock::now();
+    logging::error() << "error";
+    error_time = std::chrono::steady_clock::now() - start;
+  }
+  core.flush();
+
+  auto future = core.log_persisted(logging::level::info, std::chrono::system_clock::now(), "persisted");
+  EXPECT_TRUE(future.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+  core.remove_sink(&buffer);
+
+  // the error does not wait for the backlog and is written before it.
+  EXPECT_TRUE(error_time < std::chrono::milliseconds(500));
+  EXPECT_REGEX(buffer.str(), std::string("(info\n)?error\n(info\n)+persisted\n"));
+#endif // LOGGING_NO_THREAD
+}
+
+// --------------------------------------------------------------------------
+void test_level_gating () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  std::ostringstream buffer2;
+  core.add_sink(&buffer, logging::level::warning, core.get_console_formatter());
+
+  EXPECT_FALSE(core.is_enabled(logging::level::info));
+  EXPECT_TRUE(core.is_enabled(logging::level::warning));
+  EXPECT_FALSE(logging::info().is_enabled());
+
+  logging::info() << "skipped";
+  logging::info().stream() << "skipped";
+  logging::warn() << "written";
+
+  core.add_sink(&buffer2, logging::level::debug, core.get_console_formatter());
+  EXPECT_TRUE(core.is_enabled(logging::level::info));
+  EXPECT_FALSE(core.is_enabled(logging::level::trace));
+
+  core.set_log_level(logging::level::error);
+  EXPECT_FALSE(core.is_enabled(logging::level::warning));
+  core.set_log_level(logging::level::info);
+
+  core.flush();
+  core.remove_sink(&buffer);
+  core.remove_sink(&buffer2);
+
+  EXPECT_EQUAL(buffer.str(), std::string("written\n"));
+
+  // without sinks nothing is recorded, records are not kept for sinks added later.
+  core.remove_all_sinks();
+  EXPECT_FALSE(core.is_enabled(logging::level::fatal));
+  EXPECT_FALSE(logging::error().is_enabled());
+}
+
+// --------------------------------------------------------------------------
+void test_macros () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, core.get_console_formatter());
+
+  int evaluated = 0;
+  auto expensive = [&] () {
+    return ++evaluated;
+  };
+
+  LOG_TRACE("trace " << expensive());
+  LOG_DEBUG("debug " << expensive());
+  EXPECT_EQUAL(evaluated, 0);
+
+  LOG_INFO("info " << expensive());
+  EXPECT_EQUAL(evaluated, 1);
+
+  if (evaluated > 1)
+    LOG_WARN("not written");
+  else
+    LOG_WARN("warn " << expensive());
+
+  core.flush();
+  core.remove_sink(&buffer);
+
+  EXPECT_EQUAL(evaluated, 2);
+  EXPECT_EQUAL(buffer.str(), std::string("info 1\nwarn 2\n"));
+
+  // a sink of level trace does not bring back levels removed at compile time.
+  std::ostringstream trace_buffer;
+  const logging::level global = core.get_log_level();
+  core.set_log_level(logging::level::trace);
+  core.add_sink(&trace_buffer, logging::level::trace, core.get_console_formatter());
+  LOG_FORMAT(logging::level::trace, "trace {}", expensive());
+  core.flush();
+  core.remove_sink(&trace_buffer);
+  core.set_log_level(global);
+
+#if LOGGING_MIN_LEVEL > 1
+  EXPECT_EQUAL(evaluated, 2);
+  EXPECT_EQUAL(trace_buffer.str(), std::string());
+#else
+  EXPECT_EQUAL(evaluated, 3);
+#endif
+}
+
+// --------------------------------------------------------------------------
+void test_async_sink () {
+#ifndef LOGGING_NO_THREAD
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  std::atomic_int fast_count(0);
+  std::ostringstream fast;
+  core.add_sink(&fast, logging::level::info, [&] (std::ostream&, const logging::record&) {
+    ++fast_count;
+  });
+
+  std::mutex stuck;
+  std::ostringstream slow;
+  logging::async_sink_options options;
+  options.write_budget = std::chrono::milliseconds(1);
+  options.degraded_limits.max_records = 10;
+  core.add_async_sink(&slow, logging::level::info, [&] (std::ostream& out, const logging::record& e) {
+    std::lock_guard<std::mutex> lock(stuck);
+    out << e.message() << '\n';
+  }, options);
+
+  const int count = 100;
+  {
+    std::lock_guard<std::mutex> lock(stuck);
+    for (int i = 0; i < count; ++i) {
+      logging::info() << i;
+    }
+    // the stuck async sink must not delay the fast one.
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while ((fast_count < count) && (std::chrono::steady_clock::now() < end)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQUAL(fast_count.load(), count);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // the hanging write is detected by the next records, the queue is bounded.
+    for (int i = 0; i < count; ++i) {
+      logging::info() << i;
+    }
+    while ((fast_count < 2 * count) && (std::chrono::steady_clock::now() < end)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const logging::sink_stats hanging = core.get_sink_stats(&slow);
+    EXPECT_TRUE(hanging.degraded);
+    EXPECT_TRUE(hanging.dropped > 0);
+  }
+  core.flush();
+
+  const logging::sink_stats stats = core.get_sink_stats(&slow);
+  EXPECT_EQUAL(stats.count + stats.dropped, static_cast<std::size_t>(2 * count));
+  EXPECT_TRUE(stats.max_time > options.write_budget);
+
+  core.remove_sink(&slow);
+  core.remove_sink(&fast);
+
+  // a persisted record is written by the async sinks, when its future is ready.
+  std::ostringstream persisted;
+  core.add_async_sink(&persisted, logging::level::info, [] (std::ostream& out, const logging::record& e) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    out << e.message() << '\n';
+  });
+  auto future = core.log_persisted(logging::level::info, std::chrono::system_clock::now(), "persisted");
+  EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+  EXPECT_EQUAL(persisted.str(), std::string("persisted\n"));
+  core.remove_sink(&persisted);
+#endif // LOGGING_NO_THREAD
+}
+
+// --------------------------------------------------------------------------
+struct sync_counter : public std::stringbuf {
+  int syncs = 0;
+
+protected:
+  int sync () override {
+    ++syncs;
+    return std::stringbuf::sync();
+  }
+};
+
+void test_flush_policy () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  sync_counter every_buf, batched_buf;
+  std::ostream every(&every_buf), batched(&batched_buf);
+  core.add_sink(&every, logging::level::info, logging::core::get_console_formatter());
+  core.add_sink(&batched, logging::level::info, logging::core::get_console_formatter(),
+                logging::flush_policy::batched(1024 * 1024, std::chrono::seconds(10)));
+
+  const int count = 100;
+  for (int i = 0; i < count; ++i) {
+    logging::info() << i;
+  }
+  core.flush();
+  EXPECT_EQUAL(every_buf.syncs, count);
+  EXPECT_TRUE(batched_buf.syncs < count);
+  EXPECT_EQUAL(batched_buf.str(), every_buf.str());
+
+  // error records are flushed at once.
+  const int syncs = batched_buf.syncs;
+  logging::error() << "error";
+  core.flush();
+  EXPECT_TRUE(batched_buf.syncs > syncs);
+
+  core.remove_all_sinks();
+}
+
+// --------------------------------------------------------------------------
+struct storage_counter : public sync_counter, public logging::durable_buffer {
+  int storage_syncs = 0;
+
+  bool sync_to_storage () override {
+    ++storage_syncs;
+    return true;
+  }
+};
+
+void test_durability () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  storage_counter none_buf, flush_buf, level_buf, group_buf, periodic_buf;
+  std::ostream none(&none_buf), flush(&flush_buf), on_level(&level_buf), group(&group_buf), periodic(&periodic_buf);
+  auto fmt = logging::core::get_console_formatter();
+  core.add_sink(&none, logging::level::info, fmt, logging::flush_policy::durable(logging::durability::none));
+  core.add_sink(&flush, logging::level::info, fmt);
+  core.add_sink(&on_level, logging::level::info, fmt,
+                logging::flush_policy::durable(logging::durability::sync_on_level, logging::level::warning));
+  core.add_sink(&group, logging::level::info, fmt, logging::flush_policy::durable(logging::durability::group_commit));
+  core.add_sink(&periodic, logging::level::info, fmt,
+                logging::flush_policy::durable(logging::durability::periodic_sync, logging::level::error,
+                                               std::chrono::hours(1)));
+
+  const int count = 100;
+  for (int i = 0; i < count; ++i) {
+    logging::info() << i;
+  }
+  logging::warn() << "warning";
+  core.flush();
+
+  EXPECT_EQUAL(none_buf.storage_syncs, 0);
+  // not flushed when the sink thread goes idle, only by core::flush.
+  EXPECT_EQUAL(none_buf.syncs, 1);
+  EXPECT_EQUAL(flush_buf.storage_syncs, 0);
+  EXPECT_EQUAL(flush_buf.syncs, count + 1);
+  EXPECT_EQUAL(level_buf.storage_syncs, 1);
+  // the records of a batch share one sync.
+  EXPECT_TRUE(group_buf.storage_syncs > 0);
+  EXPECT_TRUE(group_buf.storage_syncs <= count + 1);
+  // the sync is due an hour after the first unsynced record, but core::flush syncs.
+  EXPECT_EQUAL(periodic_buf.storage_syncs, 1);
+  EXPECT_EQUAL(group_buf.str(), flush_buf.str());
+
+  // explicit sync of all sinks with a sync mode.
+  logging::info() << "sync";
+  core.sync();
+  EXPECT_EQUAL(none_buf.storage_syncs, 0);
+  EXPECT_EQUAL(flush_buf.storage_syncs, 0);
+  EXPECT_EQUAL(level_buf.storage_syncs, 2);
+  EXPECT_EQUAL(periodic_buf.storage_syncs, 2);
+
+  core.remove_all_sinks();
+  EXPECT_EQUAL(none_buf.str(), flush_buf.str());
+
+#ifndef LOGGING_NO_THREAD
+  // a periodic sync is due, while the sink thread is idle.
+  storage_counter idle_buf;
+  std::ostream idle(&idle_buf);
+  core.add_sink(&idle, logging::level::info, fmt,
+                logging::flush_policy::durable(logging::durability::periodic_sync, logging::level::error,
+                                               std::chrono::milliseconds(20)));
+  logging::info() << "idle";
+  const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((idle_buf.storage_syncs == 0) && (std::chrono::steady_clock::now() < end)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQUAL(idle_buf.storage_syncs, 1);
+  core.remove_all_sinks();
+#endif //LOGGING_NO_THREAD
+
+  // error records are not synced below the sync level, nor flushed with durability::none.
+  storage_counter error_buf, error_none_buf, error_flush_buf;
+  std::ostream error_sink(&error_buf), error_none(&error_none_buf), error_flush(&error_flush_buf);
+  core.add_sink(&error_sink, logging::level::info, fmt,
+                logging::flush_policy::durable(logging::durability::sync_on_level, logging::level::fatal));
+  core.add_sink(&error_none, logging::level::info, fmt, logging::flush_policy::durable(logging::durability::none));
+  core.add_sink(&error_flush, logging::level::info, fmt);
+  const int errors = 10;
+  for (int i = 0; i < errors; ++i) {
+    logging::error() << i;
+  }
+  const auto error_end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((error_flush_buf.syncs < errors) && (std::chrono::steady_clock::now() < error_end)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQUAL(error_flush_buf.syncs, errors);
+  EXPECT_EQUAL(error_buf.storage_syncs, 0);
+  EXPECT_EQUAL(error_none_buf.syncs, 0);
+  core.remove_all_sinks();
+}
+
+// --------------------------------------------------------------------------
+void sink_churn (bool async) {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream keep;
+  core.add_sink(&keep, logging::level::info, logging::core::get_console_formatter());
+
+  std::atomic_bool running(true);
+  std::thread producer([&] () {
+    while (running) {
+      logging::info() << "churn";
+    }
+  });
+  // holds snapshots of the sink list, and with them the async workers, while it waits for them.
+  std::thread reader([&] () {
+    while (running) {
+      core.flush();
+    }
+  });
+  auto slow_formatter = [] (std::ostream& out, const logging::record& e) {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    logging::console_formatter(out, e);
+  };
+
+  for (int i = 0; i < 50; ++i) {
+    std::ostringstream temp;
+    if (async) {
+      core.add_async_sink(&temp, logging::level::info, slow_formatter);
+    } else {
+      core.add_sink(&temp, logging::level::info, logging::core::get_console_formatter());
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    core.remove_sink(&temp);
+    // after remove_sink the stream must not be touched anymore.
+    const std::string content = temp.str();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    EXPECT_EQUAL(temp.str(), content);
+  }
+
+  running = false;
+  producer.join();
+  reader.join();
+  // write the queued records, before the next test adds its sinks.
+  core.flush();
+  core.remove_all_sinks();
+  EXPECT_FALSE(keep.str().empty());
+}
+
+void test_sink_churn () {
+  sink_churn(false);
+}
+
+void test_async_sink_churn () {
+  sink_churn(true);
+}
+
+// --------------------------------------------------------------------------
+std::atomic_int s_shared_calls(0);
+
+void shared_formatter (std::ostream& out, const logging::record& e) {
+  ++s_shared_calls;
+  logging::console_formatter(out, e);
+}
+
+void test_shared_rendering () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+
+  std::atomic_int calls(0);
+  auto counting = [&] (std::ostream& out, const logging::record& e) {
+    ++calls;
+    logging::console_formatter(out, e);
+  };
+
+  std::ostringstream std1, std2, own1, own2;
+  core.add_sink(&std1, logging::level::info, logging::core::get_standard_formatter());
+  core.add_sink(&own1, logging::level::info, counting);
+  core.add_sink(&std2, logging::level::debug, logging::core::get_standard_formatter());
+  core.add_sink(&own2, logging::level::info, counting);
+  std::ostringstream fn1, fn2;
+  core.add_sink(&fn1, logging::level::info, shared_formatter);
+  core.add_sink(&fn2, logging::level::info, shared_formatter);
+
+  logging::info() << "shared";
+  core.flush();
+  core.remove_all_sinks();
+
+  EXPECT_FALSE(std1.str().empty());
+  EXPECT_EQUAL(std1.str(), std2.str());
+  // plain functions are rendered once for all sinks.
+  EXPECT_EQUAL(s_shared_calls.load(), 1);
+  EXPECT_EQUAL(fn1.str(), "shared\n");
+  EXPECT_EQUAL(fn2.str(), "shared\n");
+  // lambdas have no identity, each sink renders its own.
+  EXPECT_EQUAL(calls.load(), 2);
+  EXPECT_EQUAL(own1.str(), "shared\n");
+  EXPECT_EQUAL(own2.str(), "shared\n");
+}
+
+// --------------------------------------------------------------------------
+struct nested {
+  int value;
+};
+
+std::ostream& operator<< (std::ostream& out, const nested& n) {
+  logging::info() << "inner " << n.value;
+  return out << "outer " << n.value;
+}
+
+void test_recorder_pool () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, logging::core::get_console_formatter());
+
+  logging::info() << std::hex << 255 << std::setw(6) << std::setfill('*') << 1;
+  // the pooled buffer must not keep the format settings.
+  logging::info() << 255 << std::setw(3) << 1;
+  logging::info() << nested{ 7 };
+  logging::info() << std::string(1000, 'x');
+  core.flush();
+  core.remove_all_sinks();
+
+  EXPECT_EQUAL(buffer.str(), "ff*****1\n255  1\ninner 7\nouter 7\n" + std::string(1000, 'x') + "\n");
+}
+
+// --------------------------------------------------------------------------
+void test_thread_names () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, [] (std::ostream& out, const logging::record& e) {
+    out << e.thread_name() << ':' << e.thread_id() << ':' << (e.os_thread_id() != 0) << '\n';
+  });
+
+  unsigned int first = 0, second = 0;
+  std::thread t1([&] () {
+    first = logging::core::set_thread_name("worker");
+    logging::info() << "1";
+  });
+  t1.join();
+  std::thread t2([&] () {
+    second = logging::core::set_thread_name("worker");
+  });
+  t2.join();
+  logging::info() << "2";
+  core.flush();
+  core.remove_all_sinks();
+
+  EXPECT_TRUE(first > 0);
+  EXPECT_EQUAL(first, second);
+  EXPECT_EQUAL(logging::thread_registry::name(first), std::string("worker"));
+  EXPECT_EQUAL(logging::thread_registry::name(0), std::string("main"));
+  EXPECT_EQUAL(buffer.str(), "worker:" + std::to_string(first) + ":1\nmain:0:1\n");
+}
+
+// --------------------------------------------------------------------------
+void test_flight_recorder () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("flight_test.log");
+  std::remove(name.c_str());
+
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, core.get_console_formatter());
+  EXPECT_FALSE(core.is_enabled(logging::level::trace));
+
+  auto recorder = std::make_shared<logging::flight_recorder>(6, name, logging::core::get_console_formatter());
+  EXPECT_EQUAL(recorder->capacity(), std::size_t(8));
+  core.add_flight_recorder(recorder, logging::level::trace);
+  EXPECT_TRUE(core.is_enabled(logging::level::trace));
+  EXPECT_EQUAL(core.get_log_level(), logging::level::info);
+
+  for (int i = 0; i < 10; ++i) {
+    core.log(logging::level::trace, "trace " + std::to_string(i));
+  }
+  core.log(logging::level::info, std::string(logging::record::inline_size * 2, 'x'));
+  core.flush();
+  EXPECT_EQUAL(recorder->size(), std::size_t(8));
+
+  std::ostringstream dump;
+  recorder->dump(dump);
+  std::string expected;
+  for (int i = 3; i < 10; ++i) {
+    expected += "trace " + std::to_string(i) + "\n";
+  }
+  expected += std::string(logging::record::inline_size, 'x') + "\n";
+  EXPECT_EQUAL(dump.str(), expected);
+  EXPECT_EQUAL(buffer.str(), std::string(logging::record::inline_size * 2, 'x') + "\n");
+
+  core.log(logging::level::fatal, "crash");
+  core.flush();
+  std::ifstream in(name);
+  std::ostringstream file;
+  file << in.rdbuf();
+  EXPECT_EQUAL(file.str(), expected.substr(expected.find('\n') + 1) + "crash\n");
+
+  core.remove_flight_recorder(recorder);
+  EXPECT_FALSE(core.is_enabled(logging::level::trace));
+  core.remove_sink(&buffer);
+  std::remove(name.c_str());
+}
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params&) {
+  testing::log_info("Running " __FILE__);
+  run_test(test_staging);
+  run_test(test_dropped_report);
+  run_test(test_priority_lane);
+  run_test(test_level_gating);
+  run_test(test_macros);
+  run_test(test_async_sink);
+  run_test(test_flush_policy);
+  run_test(test_durability);
+  run_test(test_sink_churn);
+  run_test(test_async_sink_churn);
+  run_test(test_shared_rendering);
+  run_test(test_recorder_pool);
+  run_test(test_thread_names);
+  run_test(test_flight_recorder);
+}
+
+// --------------------------------------------------------------------------
+
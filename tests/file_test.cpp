@@ -0,0 +1,302 @@
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#ifndef WIN32
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // WIN32
+
+#include <testing/testing.h>
+#include "logger.h"
+#include "core.h"
+#include "file_logger.h"
+#include "crash_handler.h"
+#include "mmap_file_logger.h"
+#include "rotating_file_logger.h"
+#include "writev_file_logger.h"
+#ifdef LOGGING_ZLIB
+#include "compressed_file_logger.h"
+#include <zlib.h>
+#endif // LOGGING_ZLIB
+
+DEFINE_LOGGING_CORE()
+
+// --------------------------------------------------------------------------
+std::string read_file (const std::string& name) {
+  std::ifstream in(name, std::ios_base::in|std::ios_base::binary);
+  std::ostringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+// --------------------------------------------------------------------------
+#ifndef WIN32
+void test_mmap_file_logger () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("mmap_test.log");
+
+  std::ostringstream expected;
+  {
+    logging::mmap_file_options options;
+    options.segment_size = 1;   // rounded up to one page, so the file rolls over segments.
+    logging::mmap_file_logger log(name, logging::level::info, core.get_console_formatter(), options);
+    for (int i = 0; i < 1000; ++i) {
+      logging::info() << "line " << i << " of the memory mapped file";
+      expected << "line " << i << " of the memory mapped file\n";
+    }
+    core.flush();
+  }
+  EXPECT_EQUAL(read_file(name), expected.str());
+  std::remove(name.c_str());
+}
+
+// --------------------------------------------------------------------------
+void test_writev_file_logger () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("writev_test.log");
+  std::remove(name.c_str());
+
+  std::ostringstream expected;
+  {
+    // small chunks, so a batch is written from many buffers.
+    logging::writev_file_buffer buffer;
+    EXPECT_TRUE(buffer.open(name, 256));
+    std::ostream out(&buffer);
+    for (int i = 0; i < 100; ++i) {
+      out << "writev line " << i << '\n';
+      expected << "writev line " << i << '\n';
+    }
+    out.flush();
+    out << "last line\n";
+    expected << "last line\n";
+    buffer.close();
+    EXPECT_EQUAL(buffer.write_calls(), std::size_t(2));
+  }
+  {
+    logging::writev_file_logger log(name, logging::level::info, core.get_console_formatter());
+    for (int i = 0; i < 1000; ++i) {
+      logging::info() << "writev record " << i;
+      expected << "writev record " << i << '\n';
+    }
+    core.flush();
+#ifndef LOGGING_NO_THREAD
+    // one call per drained batch, not per record.
+    EXPECT_TRUE(log.write_calls() < 1000);
+#endif //LOGGING_NO_THREAD
+  }
+  EXPECT_EQUAL(read_file(name), expected.str());
+  std::remove(name.c_str());
+}
+
+// --------------------------------------------------------------------------
+int overflow_stack (int depth) {
+  volatile char frame[1024];
+  frame[0] = static_cast<char>(depth);
+  return (depth < 0) ? 0 : overflow_stack(depth + 1) + frame[0];
+}
+
+void test_crash_handler () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("crash_test.log");
+
+  logging::emergency_writer writer;
+  EXPECT_TRUE(writer.add(-1, logging::level::info));
+  writer.write(logging::record(std::chrono::system_clock::time_point(std::chrono::microseconds(1500042)),
+                               logging::level::error, logging::line_id(7), "nowhere"));
+  EXPECT_EQUAL(writer.count(), std::size_t(0));
+
+  {
+    logging::file_logger file(name, logging::level::info, logging::core::get_standard_formatter());
+    core.flush();
+
+    // the child has no sink thread, its records stay queued until the crash handler drains them.
+    auto crash_child = [] (const char* message, bool overflow) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+        struct rlimit no_core = { 0, 0 };
+        setrlimit(RLIMIT_CORE, &no_core);
+        logging::crash_handler_options options;
+        options.fd = -1;
+        logging::install_crash_handler(options);
+        logging::info() << message;
+        logging::debug() << "too verbose";
+        if (overflow) {
+          overflow_stack(0);
+        }
+        raise(SIGSEGV);
+        _exit(0);
+      }
+      int status = 0;
+      EXPECT_EQUAL(waitpid(pid, &status, 0), pid);
+      EXPECT_TRUE(WIFSIGNALED(status));
+      EXPECT_EQUAL(WTERMSIG(status), SIGSEGV);
+    };
+    crash_child("last words", false);
+    // handled on the alternate signal stack.
+    crash_child("stack overflow", true);
+  }
+
+  const std::string content = read_file(name);
+  EXPECT_TRUE(content.find("|info |main|last words\n") != std::string::npos);
+  EXPECT_TRUE(content.find("|info |main|stack overflow\n") != std::string::npos);
+  EXPECT_TRUE(content.find("too verbose") == std::string::npos);
+  std::remove(name.c_str());
+}
+#endif // WIN32
+
+// --------------------------------------------------------------------------
+void test_rotating_file_logger () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("rotate_test.log");
+  const std::string first = logging::core::build_temp_log_file_name("rotate_test.1.log");
+  const std::string second = logging::core::build_temp_log_file_name("rotate_test.2.log");
+  const std::string third = logging::core::build_temp_log_file_name("rotate_test.3.log");
+  std::remove(name.c_str());
+  std::remove(third.c_str());
+
+  auto lines = [] (int from, int to) {
+    std::ostringstream out;
+    for (int i = from; i < to; ++i) {
+      out << "line " << (1000 + i) << '\n';
+    }
+    return out.str();
+  };
+
+  {
+    logging::rotation_policy policy;
+    policy.max_bytes = 100;
+    policy.max_files = 2;
+    logging::rotating_file_logger log(name, logging::level::info, core.get_console_formatter(), policy);
+    for (int i = 0; i < 35; ++i) {
+      logging::info() << "line " << (1000 + i);
+    }
+    core.flush();
+  }
+
+  // 10 bytes per line, so each file holds 10 lines, the oldest file is removed.
+  EXPECT_EQUAL(read_file(name), lines(30, 35));
+  EXPECT_EQUAL(read_file(first), lines(20, 30));
+  EXPECT_EQUAL(read_file(second), lines(10, 20));
+  EXPECT_FALSE(std::ifstream(third).good());
+  std::remove(name.c_str());
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+}
+
+// --------------------------------------------------------------------------
+#ifdef LOGGING_ZLIB
+std::string inflate_file (const std::string& name, int& members) {
+  const std::string data = read_file(name);
+  std::string result;
+  char buffer[4096];
+  members = 0;
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    z_stream stream = {};
+    inflateInit2(&stream, 16 + MAX_WBITS);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + pos));
+    stream.avail_in = static_cast<uInt>(data.size() - pos);
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+      stream.next_out = reinterpret_cast<Bytef*>(buffer);
+      stream.avail_out = sizeof(buffer);
+      ret = inflate(&stream, Z_NO_FLUSH);
+      result.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    pos += stream.total_in;
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+      break;
+    }
+    ++members;
+  }
+  return result;
+}
+
+void test_compressed_file_logger () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  const std::string name = logging::core::build_temp_log_file_name("compressed_test.log.gz");
+  std::remove(name.c_str());
+
+  // blocks are written when full or flushed by force, not on a normal flush.
+  std::ostringstream expected;
+  {
+    logging::compressed_file_buffer buffer;
+    logging::compressed_file_options options;
+    options.block_size = 4096;
+    EXPECT_TRUE(buffer.open(name, options));
+    std::ostream out(&buffer);
+    for (int i = 0; i < 500; ++i) {
+      out << "compressed line " << i << '\n';
+      expected << "compressed line " << i << '\n';
+      if (i == 10) {
+        out.flush();
+      } else if (i == 20) {
+        buffer.flush_pending();
+      }
+    }
+  }
+  int members = 0;
+  EXPECT_EQUAL(inflate_file(name, members), expected.str());
+  EXPECT_EQUAL(members, 4);
+  EXPECT_TRUE(read_file(name).size() * 4 < expected.str().size());
+
+  // appended as sink of the core.
+  {
+    logging::compressed_file_logger log(name, logging::level::info, core.get_console_formatter());
+    for (int i = 0; i < 100; ++i) {
+      logging::info() << "compressed line " << i;
+      expected << "compressed line " << i << '\n';
+    }
+    core.flush();
+  }
+  EXPECT_EQUAL(inflate_file(name, members), expected.str());
+  EXPECT_EQUAL(members, 5);
+
+#ifndef LOGGING_NO_THREAD
+  // a quiet sink writes its partial block after max_delay.
+  {
+    logging::compressed_file_logger log(name, logging::level::info, core.get_console_formatter(),
+                                        logging::compressed_file_options(),
+                                        logging::flush_policy::batched(0, std::chrono::milliseconds(20)));
+    logging::info() << "quiet line";
+    expected << "quiet line\n";
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((inflate_file(name, members) != expected.str()) && (std::chrono::steady_clock::now() < end)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQUAL(inflate_file(name, members), expected.str());
+    EXPECT_EQUAL(members, 6);
+  }
+#endif // LOGGING_NO_THREAD
+  std::remove(name.c_str());
+}
+#endif // LOGGING_ZLIB
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params&) {
+  testing::log_info("Running " __FILE__);
+#ifndef WIN32
+  run_test(test_mmap_file_logger);
+  run_test(test_writev_file_logger);
+  run_test(test_crash_handler);
+#endif // WIN32
+  run_test(test_rotating_file_logger);
+#ifdef LOGGING_ZLIB
+  run_test(test_compressed_file_logger);
+#endif // LOGGING_ZLIB
+}
+
+// --------------------------------------------------------------------------
+
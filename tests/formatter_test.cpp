@@ -1,10 +1,13 @@
 
 #include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include <testing/testing.h>
 #include "logger.h"
 #include "core.h"
 #include "formatter.h"
+#include "binary_logger.h"
 
 DEFINE_LOGGING_CORE()
 
@@ -112,6 +115,139 @@ void test_date_and_time_formatter () {
   EXPECT_EQUAL(buffer.str(), expected.str());
 }
 
+// --------------------------------------------------------------------------
+void test_time_point_cache () {
+  using namespace std::chrono;
+  using logging::operator<<;
+  const system_clock::time_point base = system_clock::from_time_t(1600000000);
+
+  auto expected = [] (const system_clock::time_point& tp, long micros) {
+    std::time_t tt = system_clock::to_time_t(tp);
+    std::tm t;
+#ifdef WIN32
+    localtime_s(&t, &tt);
+#else
+    localtime_r(&tt, &t);
+#endif
+    std::ostringstream out;
+    out << std::setfill('0') << (t.tm_year + 1900) << '-' << std::setw(2) << (t.tm_mon + 1) << '-' << std::setw(2) << t.tm_mday
+        << ' ' << std::setw(2) << t.tm_hour << ':' << std::setw(2) << t.tm_min << ':' << std::setw(2) << t.tm_sec
+        << '.' << std::setw(6) << micros;
+    return out.str();
+  };
+
+  // same second with other micro seconds, then the next seconds.
+  const long micros[] = { 0, 42, 999999 };
+  for (int sec = 0; sec < 3; ++sec) {
+    for (long us : micros) {
+      const system_clock::time_point tp = base + seconds(sec) + microseconds(us);
+      std::ostringstream out;
+      out << tp;
+      EXPECT_EQUAL(out.str(), expected(base + seconds(sec), us));
+    }
+  }
+}
+
+// --------------------------------------------------------------------------
+void test_recorder_numbers () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+  core.add_sink(&buffer, logging::level::info, core.get_console_formatter());
+
+  int value = 0;
+  const void* address = &value;
+  const void* null = nullptr;
+  std::ostringstream expected_address;
+  expected_address << address << ' ' << null;
+
+  logging::info() << -42 << ' ' << 18446744073709551615ULL << ' ' << short(7) << ' ' << true;
+  logging::info() << 3.14159265 << ' ' << 1e10 << ' ' << 0.5f << ' ' << std::setprecision(3) << 3.14159265;
+  logging::info() << address << ' ' << null;
+  logging::info() << std::chrono::milliseconds(15) << ' ' << std::chrono::seconds(2) << ' '
+                  << std::chrono::minutes(3) << ' ' << std::chrono::duration<int, std::ratio<1, 10>>(5);
+  logging::info() << std::hex << 255 << ' ' << std::setw(4) << std::setfill('0') << std::dec << 7;
+  logging::info() << std::string_view("a\tb") << ' ' << 'c';
+  core.flush();
+  core.remove_sink(&buffer);
+
+  EXPECT_EQUAL(buffer.str(), "-42 18446744073709551615 7 1\n"
+                             "3.14159 1e+10 0.5 3.14\n" +
+                             expected_address.str() + "\n"
+                             "15ms 2s 3min 5[1/10]s\n"
+                             "ff 0007\n"
+                             "a\\tb c\n");
+}
+
+// --------------------------------------------------------------------------
+void test_structured_fields () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream buffer;
+
+  using namespace logging;
+
+  core.add_sink(&buffer, level::info, custom_formatter({fmt::message, fmt::character<' '>, fmt::fields_json, fmt::endl}));
+  const std::string path = "/a \"b\"";
+  logging::info() << "done" << logging::field("status", 200) << logging::field("ratio", 0.5)
+                  << logging::field("ok", true) << logging::field("path", path) << logging::field("sep", ',');
+  const std::string large(record::inline_size, 'x');
+  logging::info() << "large" << logging::field("text", large) << logging::field("n", -1);
+  logging::info() << "nan" << logging::field("a", std::numeric_limits<double>::quiet_NaN())
+                  << logging::field("b", -std::numeric_limits<double>::infinity());
+  core.flush();
+  core.remove_sink(&buffer);
+
+  EXPECT_EQUAL(buffer.str(), "done {\"status\":200,\"ratio\":0.5,\"ok\":true,\"path\":\"/a \\\"b\\\"\",\"sep\":\",\"}\n"
+                             "large {\"text\":\"" + large + "\",\"n\":-1}\n"
+                             "nan {\"a\":null,\"b\":null}\n");
+
+  std::ostringstream console;
+  core.add_sink(&console, level::info, core.get_console_formatter());
+  logging::info() << "plain";
+  logging::info() << "kv" << logging::field("a", 1) << logging::field("b", "x");
+  logging::info() << "chars" << logging::field("sep", ',') << logging::field("u8", static_cast<unsigned char>(44));
+  core.flush();
+  core.remove_sink(&console);
+
+  EXPECT_EQUAL(console.str(), std::string("plain\nkv a=1 b=x\nchars sep=, u8=44\n"));
+}
+
+// --------------------------------------------------------------------------
+void test_deferred_format () {
+  logging::core& core = logging::core::instance();
+  core.remove_all_sinks();
+  std::ostringstream text;
+  std::stringstream binary(std::ios_base::in|std::ios_base::out|std::ios_base::binary);
+  core.add_sink(&text, logging::level::info, core.get_no_time_formatter());
+  core.add_sink(&binary, logging::level::info, logging::binary_formatter());
+
+  const std::string name = "disk";
+  for (int i = 0; i < 2; ++i) {
+    LOG_FORMAT(logging::level::info, "{} of {} at {}%, ok={}", name, i, 12.5, true);
+  }
+  LOG_FORMAT(logging::level::warning, "no arguments");
+  logging::info() << "text" << logging::field("k", 1);
+  core.flush();
+  core.remove_sink(&text);
+  core.remove_sink(&binary);
+
+  const std::string expected = "info |main|disk of 0 at 12.5%, ok=true\n"
+                               "info |main|disk of 1 at 12.5%, ok=true\n"
+                               "warn |main|no arguments\n"
+                               "info |main|text k=1\n";
+  EXPECT_EQUAL(text.str(), expected);
+
+  logging::binary_reader reader(binary);
+  EXPECT_TRUE(reader.is_valid());
+  std::ostringstream decoded;
+  logging::record entry;
+  while (reader.read(entry)) {
+    logging::no_time_formatter(decoded, entry);
+  }
+  EXPECT_EQUAL(decoded.str(), expected);
+}
+
 // --------------------------------------------------------------------------
 void test_main (const testing::start_params&) {
   testing::log_info("Running " __FILE__);
@@ -122,6 +258,10 @@ void test_main (const testing::start_params&) {
   run_test(test_custom_formatter);
   run_test(test_dynamic_formatter);
   run_test(test_date_and_time_formatter);
+  run_test(test_time_point_cache);
+  run_test(test_recorder_numbers);
+  run_test(test_structured_fields);
+  run_test(test_deferred_format);
 }
 
 // --------------------------------------------------------------------------
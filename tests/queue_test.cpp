@@ -0,0 +1,296 @@
+
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <testing/testing.h>
+#include "message_queue.h"
+#include "ring_queue.h"
+#include "staging_buffer.h"
+#include "core.h"
+
+DEFINE_LOGGING_CORE()
+
+// --------------------------------------------------------------------------
+logging::record make_record (unsigned int id, const std::string& msg, logging::level lvl = logging::level::info) {
+  return logging::record(std::chrono::system_clock::now(), lvl, logging::line_id(id), msg);
+}
+
+// --------------------------------------------------------------------------
+void test_ring_queue_capacity () {
+  logging::ring_queue queue(100);
+  EXPECT_EQUAL(queue.capacity(), std::size_t(128));
+  EXPECT_TRUE(queue.empty());
+}
+
+// --------------------------------------------------------------------------
+void test_ring_queue_fifo () {
+  logging::ring_queue queue(4);
+  for (unsigned int i = 1; i < 4; ++i) {
+    queue.enqueue(make_record(i, std::to_string(i)));
+  }
+  EXPECT_FALSE(queue.empty());
+
+  logging::record r;
+  for (unsigned int i = 1; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_dequeue(r));
+    EXPECT_EQUAL(r.line().n, i);
+    EXPECT_EQUAL(r.message(), std::to_string(i));
+  }
+  EXPECT_FALSE(queue.try_dequeue(r));
+  EXPECT_TRUE(queue.empty());
+}
+
+// --------------------------------------------------------------------------
+void test_ring_queue_producers () {
+  const unsigned int producers = 4;
+  const unsigned int count = 10000;
+  logging::ring_queue queue(64);
+
+  std::vector<std::thread> threads;
+  for (unsigned int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] () {
+      for (unsigned int i = 0; i < count; ++i) {
+        queue.enqueue(make_record(p * count + i, std::string()));
+      }
+    });
+  }
+
+  std::vector<unsigned int> last(producers, 0);
+  unsigned int received = 0;
+  bool ordered = true;
+  while (received < producers * count) {
+    logging::record r = queue.dequeue();
+    const unsigned int p = r.line().n / count;
+    const unsigned int i = r.line().n % count;
+    ordered &= (i == 0) || (i == last[p] + 1);
+    last[p] = i;
+    ++received;
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQUAL(received, producers * count);
+  EXPECT_TRUE(queue.empty());
+}
+
+// --------------------------------------------------------------------------
+void test_message_queue_fifo () {
+  logging::message_queue queue;
+  for (unsigned int i = 1; i < 4; ++i) {
+    queue.enqueue(make_record(i, std::to_string(i)));
+  }
+
+  logging::record r = queue.dequeue();
+  EXPECT_EQUAL(r.line().n, 1u);
+  for (unsigned int i = 2; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_dequeue(r));
+    EXPECT_EQUAL(r.line().n, i);
+  }
+  EXPECT_FALSE(queue.try_dequeue(r));
+}
+
+// --------------------------------------------------------------------------
+template<typename Q>
+void test_drain () {
+  Q queue;
+  for (unsigned int i = 1; i < 4; ++i) {
+    queue.enqueue(make_record(i, std::to_string(i)));
+  }
+  logging::record r;
+  EXPECT_TRUE(queue.try_dequeue(r));
+
+  std::vector<logging::record> items;
+  EXPECT_EQUAL(queue.drain(items), std::size_t(2));
+  EXPECT_EQUAL(items.size(), std::size_t(2));
+  EXPECT_EQUAL(items[0].message(), std::string("2"));
+  EXPECT_EQUAL(items[1].message(), std::string("3"));
+  EXPECT_FALSE(queue.try_dequeue(r));
+
+  queue.enqueue(make_record(4, "4"));
+  EXPECT_EQUAL(queue.drain(items), std::size_t(1));
+  EXPECT_EQUAL(items.size(), std::size_t(3));
+  EXPECT_EQUAL(items[2].message(), std::string("4"));
+  EXPECT_EQUAL(queue.drain(items), std::size_t(0));
+}
+
+void test_message_queue_drain () {
+  test_drain<logging::message_queue>();
+}
+
+void test_ring_queue_drain () {
+  test_drain<logging::ring_queue>();
+}
+
+// --------------------------------------------------------------------------
+template<typename Q>
+void test_drop_newest () {
+  Q queue;
+  logging::queue_limits limits;
+  limits.max_records = 2;
+  limits.policy = logging::overflow_policy::drop_newest;
+  queue.set_limits(limits);
+
+  for (unsigned int i = 1; i < 5; ++i) {
+    queue.enqueue(make_record(i, std::to_string(i)));
+  }
+  EXPECT_EQUAL(queue.dropped().get(logging::level::info), std::size_t(2));
+
+  std::vector<logging::record> items;
+  EXPECT_EQUAL(queue.drain(items), std::size_t(2));
+  EXPECT_EQUAL(items[0].line().n, 1u);
+  EXPECT_EQUAL(items[1].line().n, 2u);
+}
+
+template<typename Q>
+void test_drop_below_level () {
+  Q queue;
+  logging::queue_limits limits;
+  limits.max_records = 1;
+  limits.policy = logging::overflow_policy::drop_below_level;
+  limits.drop_level = logging::level::warning;
+  queue.set_limits(limits);
+
+  queue.enqueue(make_record(1, "1"));
+  queue.enqueue(make_record(2, "2", logging::level::debug));
+  queue.enqueue(make_record(3, "3", logging::level::info));
+  EXPECT_EQUAL(queue.dropped().get(logging::level::debug), std::size_t(1));
+  EXPECT_EQUAL(queue.dropped().get(logging::level::info), std::size_t(1));
+
+  // a warning waits until there is room.
+  std::thread producer([&] () {
+    queue.enqueue(make_record(4, "4", logging::level::warning));
+  });
+  std::vector<logging::record> items;
+  while (items.size() < 2) {
+    queue.drain(items);
+    std::this_thread::yield();
+  }
+  producer.join();
+  EXPECT_EQUAL(items[0].line().n, 1u);
+  EXPECT_EQUAL(items[1].line().n, 4u);
+  EXPECT_EQUAL(queue.dropped().get(logging::level::warning), std::size_t(0));
+}
+
+void test_message_queue_drop_newest () {
+  test_drop_newest<logging::message_queue>();
+}
+
+void test_ring_queue_drop_newest () {
+  test_drop_newest<logging::ring_queue>();
+}
+
+void test_message_queue_drop_below_level () {
+  test_drop_below_level<logging::message_queue>();
+}
+
+void test_ring_queue_drop_below_level () {
+  test_drop_below_level<logging::ring_queue>();
+}
+
+// --------------------------------------------------------------------------
+void test_message_queue_drop_oldest () {
+  logging::message_queue queue;
+  logging::queue_limits limits;
+  limits.max_bytes = 3 * make_record(0, "x").byte_size();
+  limits.policy = logging::overflow_policy::drop_oldest;
+  queue.set_limits(limits);
+
+  for (unsigned int i = 1; i < 6; ++i) {
+    queue.enqueue(make_record(i, "x"));
+  }
+  EXPECT_EQUAL(queue.dropped().get(logging::level::info), std::size_t(2));
+
+  std::vector<logging::record> items;
+  EXPECT_EQUAL(queue.drain(items), std::size_t(3));
+  EXPECT_EQUAL(items[0].line().n, 3u);
+  EXPECT_EQUAL(items[2].line().n, 5u);
+}
+
+// --------------------------------------------------------------------------
+void test_staging_buffer () {
+  logging::staging_buffer buffer(2);
+  logging::record r1 = make_record(1, "1");
+  logging::record r2 = make_record(2, "2");
+  logging::record r3 = make_record(3, "3");
+  EXPECT_TRUE(buffer.try_enqueue(r1));
+  EXPECT_TRUE(buffer.try_enqueue(r2));
+  EXPECT_FALSE(buffer.try_enqueue(r3));
+  EXPECT_EQUAL(r3.message(), std::string("3"));
+
+  logging::record r;
+  EXPECT_TRUE(buffer.try_dequeue(r));
+  EXPECT_EQUAL(r.line().n, 1u);
+  EXPECT_TRUE(buffer.try_enqueue(r3));
+  EXPECT_TRUE(buffer.try_dequeue(r));
+  EXPECT_EQUAL(r.line().n, 2u);
+  EXPECT_TRUE(buffer.try_dequeue(r));
+  EXPECT_EQUAL(r.line().n, 3u);
+  EXPECT_FALSE(buffer.try_dequeue(r));
+  EXPECT_TRUE(buffer.empty());
+
+  EXPECT_FALSE(buffer.is_closed());
+  buffer.close();
+  EXPECT_TRUE(buffer.is_closed());
+}
+
+// --------------------------------------------------------------------------
+void test_record_layout () {
+  EXPECT_EQUAL(sizeof(logging::record), std::size_t(LOGGING_RECORD_SIZE));
+  EXPECT_EQUAL(alignof(logging::record), logging::cache_line_size);
+
+  logging::record small = make_record(1, "short");
+  EXPECT_EQUAL(small.byte_size(), sizeof(logging::record));
+  EXPECT_EQUAL(small.thread_name(), std::string("main"));
+  EXPECT_EQUAL(small.message(), std::string("short"));
+
+  const std::string text(logging::record::inline_size * 3, 'x');
+  logging::record large = make_record(2, text);
+  EXPECT_TRUE(large.byte_size() > sizeof(logging::record));
+  EXPECT_EQUAL(large.message(), text);
+
+  logging::record copy(large);
+  EXPECT_EQUAL(copy.message(), text);
+  EXPECT_EQUAL(copy.thread_name(), std::string("main"));
+
+  logging::record moved(std::move(large));
+  EXPECT_EQUAL(moved.message(), text);
+  EXPECT_TRUE(large.message().empty());
+
+  copy = small;
+  EXPECT_EQUAL(copy.message(), std::string("short"));
+  small = std::move(moved);
+  EXPECT_EQUAL(small.message(), text);
+  EXPECT_EQUAL(small.line().n, 2u);
+
+  // empty views without data.
+  logging::record empty(std::chrono::system_clock::now(), logging::level::info, logging::line_id(3),
+                        std::string_view(), std::string_view());
+  EXPECT_TRUE(empty.message().empty());
+  EXPECT_TRUE(empty.fields().empty());
+}
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params&) {
+  testing::log_info("Running " __FILE__);
+  run_test(test_ring_queue_capacity);
+  run_test(test_ring_queue_fifo);
+  run_test(test_ring_queue_producers);
+  run_test(test_message_queue_fifo);
+  run_test(test_message_queue_drain);
+  run_test(test_ring_queue_drain);
+  run_test(test_message_queue_drop_newest);
+  run_test(test_ring_queue_drop_newest);
+  run_test(test_message_queue_drop_below_level);
+  run_test(test_ring_queue_drop_below_level);
+  run_test(test_message_queue_drop_oldest);
+  run_test(test_staging_buffer);
+  run_test(test_record_layout);
+}
+
+// --------------------------------------------------------------------------
+
@@ -0,0 +1,67 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    logging lib
+*
+* @brief     Decoder of binary log files
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// --------------------------------------------------------------------------
+//
+// Library includes
+//
+#include "binary_logger.h"
+#include "formatter.h"
+
+// the shared library defines the core, a static build needs it in the executable.
+#if defined(LOGGING_BUILT_AS_STATIC_LIB)
+DEFINE_LOGGING_CORE()
+#endif
+
+int main (int argc, char* argv[]) {
+  if ((argc < 2) || (argc > 3)) {
+    std::cerr << "usage: " << argv[0] << " <binary log file> [standard|no_time|console]" << std::endl;
+    return 1;
+  }
+
+  logging::record_formatter formatter = logging::standard_formatter;
+  if (argc == 3) {
+    if (std::strcmp(argv[2], "no_time") == 0) {
+      formatter = logging::no_time_formatter;
+    } else if (std::strcmp(argv[2], "console") == 0) {
+      formatter = logging::console_formatter;
+    } else if (std::strcmp(argv[2], "standard") != 0) {
+      std::cerr << "unknown formatter: " << argv[2] << std::endl;
+      return 1;
+    }
+  }
+
+  std::ifstream in(argv[1], std::ios_base::in|std::ios_base::binary);
+  logging::binary_reader reader(in);
+  if (!reader.is_valid()) {
+    std::cerr << "not a binary log file: " << argv[1] << std::endl;
+    return 1;
+  }
+
+  logging::record entry;
+  while (reader.read(entry)) {
+    formatter(std::cout, entry);
+  }
+  return 0;
+}